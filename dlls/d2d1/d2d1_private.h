@@ -20,6 +20,7 @@
 #define __WINE_D2D1_PRIVATE_H
 
 #include "wine/debug.h"
+#include "wine/list.h"
 
 #include <assert.h>
 #include <limits.h>
@@ -58,6 +59,27 @@ struct d2d_clip_stack
     unsigned int count;
 };
 
+enum d2d_geometry_buffer
+{
+    D2D_GEOMETRY_BUFFER_FILL_FACES,
+    D2D_GEOMETRY_BUFFER_FILL_VERTICES,
+    D2D_GEOMETRY_BUFFER_FILL_BEZIER_VERTICES,
+    D2D_GEOMETRY_BUFFER_OUTLINE_FACES,
+    D2D_GEOMETRY_BUFFER_OUTLINE_VERTICES,
+    D2D_GEOMETRY_BUFFER_OUTLINE_BEZIER_FACES,
+    D2D_GEOMETRY_BUFFER_OUTLINE_BEZIERS,
+    D2D_GEOMETRY_BUFFER_COUNT,
+};
+
+/* Buffers created from the fill and outline data of a geometry, cached by the
+ * render target drawing it. */
+struct d2d_geometry_buffers
+{
+    struct list entry;
+    LONG geometry_id;
+    ID3D10Buffer *buffers[D2D_GEOMETRY_BUFFER_COUNT];
+};
+
 struct d2d_error_state
 {
     HRESULT code;
@@ -99,6 +121,9 @@ struct d2d_d3d_render_target
     D2D1_RENDER_TARGET_PROPERTIES desc;
     D2D1_SIZE_U pixel_size;
     struct d2d_clip_stack clip_stack;
+
+    struct list geometry_buffers;
+    unsigned int geometry_buffer_count;
 };
 
 HRESULT d2d_d3d_create_render_target(ID2D1Factory *factory, IDXGISurface *surface, IUnknown *outer_unknown,
@@ -379,6 +404,8 @@ struct d2d_geometry
         size_t bezier_face_count;
     } outline;
 
+    LONG id;
+
     union
     {
         struct
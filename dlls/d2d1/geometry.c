@@ -2001,6 +2001,15 @@ static void d2d_geometry_cleanup(struct d2d_geometry *geometry)
     ID2D1Factory_Release(geometry->factory);
 }
 
+/* Render targets cache the buffers created from the fill and outline data by
+ * this id, so it has to change whenever that data does. */
+static void d2d_geometry_update_id(struct d2d_geometry *geometry)
+{
+    static LONG next_id;
+
+    geometry->id = InterlockedIncrement(&next_id);
+}
+
 static void d2d_geometry_init(struct d2d_geometry *geometry, ID2D1Factory *factory,
         const D2D1_MATRIX_3X2_F *transform, const struct ID2D1GeometryVtbl *vtbl)
 {
@@ -2008,6 +2017,7 @@ static void d2d_geometry_init(struct d2d_geometry *geometry, ID2D1Factory *facto
     geometry->refcount = 1;
     ID2D1Factory_AddRef(geometry->factory = factory);
     geometry->transform = *transform;
+    d2d_geometry_update_id(geometry);
 }
 
 static inline struct d2d_geometry *impl_from_ID2D1GeometrySink(ID2D1GeometrySink *iface)
@@ -2201,6 +2211,7 @@ static void STDMETHODCALLTYPE d2d_geometry_sink_EndFigure(ID2D1GeometrySink *ifa
             --figure->vertex_count;
     }
 
+    d2d_geometry_update_id(geometry);
     if (!d2d_geometry_add_figure_outline(geometry, figure, figure_end))
     {
         ERR("Failed to add figure outline.\n");
@@ -2318,6 +2329,7 @@ done:
         d2d_path_geometry_free_figures(geometry);
         geometry->u.path.state = D2D_GEOMETRY_STATE_ERROR;
     }
+    d2d_geometry_update_id(geometry);
     return hr;
 }
 
@@ -3445,6 +3457,7 @@ void d2d_transformed_geometry_init(struct d2d_geometry *geometry, ID2D1Factory *
     geometry->u.transformed.transform = *transform;
     geometry->fill = src_impl->fill;
     geometry->outline = src_impl->outline;
+    geometry->id = src_impl->id;
 }
 
 struct d2d_geometry *unsafe_impl_from_ID2D1Geometry(ID2D1Geometry *iface)
@@ -126,6 +126,145 @@ static void d2d_clip_stack_pop(struct d2d_clip_stack *stack)
     --stack->count;
 }
 
+/* Geometries drawn by a render target are typically drawn again in the next
+ * frames, keep the buffers of the most recently drawn ones around. */
+#define D2D_GEOMETRY_BUFFERS_CACHE_SIZE 64
+
+static void d2d_geometry_buffers_destroy(struct d2d_geometry_buffers *buffers)
+{
+    unsigned int i;
+
+    for (i = 0; i < ARRAY_SIZE(buffers->buffers); ++i)
+    {
+        if (buffers->buffers[i])
+            ID3D10Buffer_Release(buffers->buffers[i]);
+    }
+    HeapFree(GetProcessHeap(), 0, buffers);
+}
+
+static void d2d_rt_cleanup_geometry_buffers(struct d2d_d3d_render_target *render_target)
+{
+    struct d2d_geometry_buffers *buffers, *next;
+
+    LIST_FOR_EACH_ENTRY_SAFE(buffers, next, &render_target->geometry_buffers, struct d2d_geometry_buffers, entry)
+    {
+        list_remove(&buffers->entry);
+        d2d_geometry_buffers_destroy(buffers);
+    }
+    render_target->geometry_buffer_count = 0;
+}
+
+static struct d2d_geometry_buffers *d2d_rt_get_geometry_buffers(struct d2d_d3d_render_target *render_target,
+        const struct d2d_geometry *geometry)
+{
+    struct d2d_geometry_buffers *buffers;
+
+    LIST_FOR_EACH_ENTRY(buffers, &render_target->geometry_buffers, struct d2d_geometry_buffers, entry)
+    {
+        if (buffers->geometry_id == geometry->id)
+        {
+            list_remove(&buffers->entry);
+            list_add_head(&render_target->geometry_buffers, &buffers->entry);
+            return buffers;
+        }
+    }
+
+    /* Drop the least recently drawn entry once the cache is full. */
+    if (render_target->geometry_buffer_count == D2D_GEOMETRY_BUFFERS_CACHE_SIZE)
+    {
+        buffers = LIST_ENTRY(list_tail(&render_target->geometry_buffers), struct d2d_geometry_buffers, entry);
+        list_remove(&buffers->entry);
+        d2d_geometry_buffers_destroy(buffers);
+        --render_target->geometry_buffer_count;
+    }
+
+    if (!(buffers = HeapAlloc(GetProcessHeap(), HEAP_ZERO_MEMORY, sizeof(*buffers))))
+        return NULL;
+    buffers->geometry_id = geometry->id;
+    list_add_head(&render_target->geometry_buffers, &buffers->entry);
+    ++render_target->geometry_buffer_count;
+
+    return buffers;
+}
+
+/* Returns a buffer with the requested fill or outline data of the geometry,
+ * created on first use and kept by the render target until the geometry
+ * changes or drops out of the cache. */
+static HRESULT d2d_rt_get_geometry_buffer(struct d2d_d3d_render_target *render_target,
+        const struct d2d_geometry *geometry, enum d2d_geometry_buffer idx, ID3D10Buffer **buffer)
+{
+    struct d2d_geometry_buffers *buffers;
+    D3D10_SUBRESOURCE_DATA buffer_data;
+    D3D10_BUFFER_DESC buffer_desc;
+    HRESULT hr;
+
+    if (!(buffers = d2d_rt_get_geometry_buffers(render_target, geometry)))
+        return E_OUTOFMEMORY;
+
+    if ((*buffer = buffers->buffers[idx]))
+        return S_OK;
+
+    buffer_desc.Usage = D3D10_USAGE_DEFAULT;
+    buffer_desc.BindFlags = D3D10_BIND_VERTEX_BUFFER;
+    buffer_desc.CPUAccessFlags = 0;
+    buffer_desc.MiscFlags = 0;
+
+    switch (idx)
+    {
+        case D2D_GEOMETRY_BUFFER_FILL_FACES:
+            buffer_desc.ByteWidth = geometry->fill.face_count * sizeof(*geometry->fill.faces);
+            buffer_desc.BindFlags = D3D10_BIND_INDEX_BUFFER;
+            buffer_data.pSysMem = geometry->fill.faces;
+            break;
+
+        case D2D_GEOMETRY_BUFFER_FILL_VERTICES:
+            buffer_desc.ByteWidth = geometry->fill.vertex_count * sizeof(*geometry->fill.vertices);
+            buffer_data.pSysMem = geometry->fill.vertices;
+            break;
+
+        case D2D_GEOMETRY_BUFFER_FILL_BEZIER_VERTICES:
+            buffer_desc.ByteWidth = geometry->fill.bezier_vertex_count * sizeof(*geometry->fill.bezier_vertices);
+            buffer_data.pSysMem = geometry->fill.bezier_vertices;
+            break;
+
+        case D2D_GEOMETRY_BUFFER_OUTLINE_FACES:
+            buffer_desc.ByteWidth = geometry->outline.face_count * sizeof(*geometry->outline.faces);
+            buffer_desc.BindFlags = D3D10_BIND_INDEX_BUFFER;
+            buffer_data.pSysMem = geometry->outline.faces;
+            break;
+
+        case D2D_GEOMETRY_BUFFER_OUTLINE_VERTICES:
+            buffer_desc.ByteWidth = geometry->outline.vertex_count * sizeof(*geometry->outline.vertices);
+            buffer_data.pSysMem = geometry->outline.vertices;
+            break;
+
+        case D2D_GEOMETRY_BUFFER_OUTLINE_BEZIER_FACES:
+            buffer_desc.ByteWidth = geometry->outline.bezier_face_count * sizeof(*geometry->outline.bezier_faces);
+            buffer_desc.BindFlags = D3D10_BIND_INDEX_BUFFER;
+            buffer_data.pSysMem = geometry->outline.bezier_faces;
+            break;
+
+        case D2D_GEOMETRY_BUFFER_OUTLINE_BEZIERS:
+            buffer_desc.ByteWidth = geometry->outline.bezier_count * sizeof(*geometry->outline.beziers);
+            buffer_data.pSysMem = geometry->outline.beziers;
+            break;
+
+        default:
+            ERR("Invalid buffer %#x.\n", idx);
+            return E_INVALIDARG;
+    }
+
+    buffer_data.SysMemPitch = 0;
+    buffer_data.SysMemSlicePitch = 0;
+
+    if (FAILED(hr = ID3D10Device_CreateBuffer(render_target->device, &buffer_desc,
+            &buffer_data, &buffers->buffers[idx])))
+        return hr;
+
+    *buffer = buffers->buffers[idx];
+    return S_OK;
+}
+
 static void d2d_rt_draw(struct d2d_d3d_render_target *render_target, enum d2d_shape_type shape_type,
         ID3D10Buffer *ib, unsigned int index_count, ID3D10Buffer *vb, unsigned int vb_stride,
         ID3D10Buffer *vs_cb, ID3D10Buffer *ps_cb, struct d2d_brush *brush, struct d2d_brush *opacity_brush)
@@ -248,6 +387,7 @@ static ULONG STDMETHODCALLTYPE d2d_d3d_render_target_Release(ID2D1RenderTarget *
     {
         unsigned int i, j, k;
 
+        d2d_rt_cleanup_geometry_buffers(render_target);
         d2d_clip_stack_cleanup(&render_target->clip_stack);
         IDWriteRenderingParams_Release(render_target->default_text_rendering_params);
         if (render_target->text_rendering_params)
@@ -692,62 +832,42 @@ static void d2d_rt_draw_geometry(struct d2d_d3d_render_target *render_target,
 
     if (geometry->outline.face_count)
     {
-        buffer_desc.ByteWidth = geometry->outline.face_count * sizeof(*geometry->outline.faces);
-        buffer_desc.BindFlags = D3D10_BIND_INDEX_BUFFER;
-        buffer_data.pSysMem = geometry->outline.faces;
-
-        if (FAILED(hr = ID3D10Device_CreateBuffer(render_target->device, &buffer_desc, &buffer_data, &ib)))
+        if (FAILED(hr = d2d_rt_get_geometry_buffer(render_target, geometry,
+                D2D_GEOMETRY_BUFFER_OUTLINE_FACES, &ib)))
         {
             WARN("Failed to create index buffer, hr %#x.\n", hr);
             goto done;
         }
 
-        buffer_desc.ByteWidth = geometry->outline.vertex_count * sizeof(*geometry->outline.vertices);
-        buffer_desc.BindFlags = D3D10_BIND_VERTEX_BUFFER;
-        buffer_data.pSysMem = geometry->outline.vertices;
-
-        if (FAILED(hr = ID3D10Device_CreateBuffer(render_target->device, &buffer_desc, &buffer_data, &vb)))
+        if (FAILED(hr = d2d_rt_get_geometry_buffer(render_target, geometry,
+                D2D_GEOMETRY_BUFFER_OUTLINE_VERTICES, &vb)))
         {
             ERR("Failed to create vertex buffer, hr %#x.\n", hr);
-            ID3D10Buffer_Release(ib);
             goto done;
         }
 
         d2d_rt_draw(render_target, D2D_SHAPE_TYPE_OUTLINE, ib, 3 * geometry->outline.face_count, vb,
                 sizeof(*geometry->outline.vertices), vs_cb, ps_cb, brush, NULL);
-
-        ID3D10Buffer_Release(vb);
-        ID3D10Buffer_Release(ib);
     }
 
     if (geometry->outline.bezier_face_count)
     {
-        buffer_desc.ByteWidth = geometry->outline.bezier_face_count * sizeof(*geometry->outline.bezier_faces);
-        buffer_desc.BindFlags = D3D10_BIND_INDEX_BUFFER;
-        buffer_data.pSysMem = geometry->outline.bezier_faces;
-
-        if (FAILED(hr = ID3D10Device_CreateBuffer(render_target->device, &buffer_desc, &buffer_data, &ib)))
+        if (FAILED(hr = d2d_rt_get_geometry_buffer(render_target, geometry,
+                D2D_GEOMETRY_BUFFER_OUTLINE_BEZIER_FACES, &ib)))
         {
             WARN("Failed to create beziers index buffer, hr %#x.\n", hr);
             goto done;
         }
 
-        buffer_desc.ByteWidth = geometry->outline.bezier_count * sizeof(*geometry->outline.beziers);
-        buffer_desc.BindFlags = D3D10_BIND_VERTEX_BUFFER;
-        buffer_data.pSysMem = geometry->outline.beziers;
-
-        if (FAILED(hr = ID3D10Device_CreateBuffer(render_target->device, &buffer_desc, &buffer_data, &vb)))
+        if (FAILED(hr = d2d_rt_get_geometry_buffer(render_target, geometry,
+                D2D_GEOMETRY_BUFFER_OUTLINE_BEZIERS, &vb)))
         {
             ERR("Failed to create beziers vertex buffer, hr %#x.\n", hr);
-            ID3D10Buffer_Release(ib);
             goto done;
         }
 
         d2d_rt_draw(render_target, D2D_SHAPE_TYPE_BEZIER_OUTLINE, ib, 3 * geometry->outline.bezier_face_count, vb,
                 sizeof(*geometry->outline.beziers), vs_cb, ps_cb, brush, NULL);
-
-        ID3D10Buffer_Release(vb);
-        ID3D10Buffer_Release(ib);
     }
 
 done:
@@ -833,40 +953,28 @@ static void d2d_rt_fill_geometry(struct d2d_d3d_render_target *render_target,
 
     if (geometry->fill.face_count)
     {
-        buffer_desc.ByteWidth = geometry->fill.face_count * sizeof(*geometry->fill.faces);
-        buffer_desc.BindFlags = D3D10_BIND_INDEX_BUFFER;
-        buffer_data.pSysMem = geometry->fill.faces;
-
-        if (FAILED(hr = ID3D10Device_CreateBuffer(render_target->device, &buffer_desc, &buffer_data, &ib)))
+        if (FAILED(hr = d2d_rt_get_geometry_buffer(render_target, geometry,
+                D2D_GEOMETRY_BUFFER_FILL_FACES, &ib)))
         {
             WARN("Failed to create index buffer, hr %#x.\n", hr);
             goto done;
         }
 
-        buffer_desc.ByteWidth = geometry->fill.vertex_count * sizeof(*geometry->fill.vertices);
-        buffer_desc.BindFlags = D3D10_BIND_VERTEX_BUFFER;
-        buffer_data.pSysMem = geometry->fill.vertices;
-
-        if (FAILED(hr = ID3D10Device_CreateBuffer(render_target->device, &buffer_desc, &buffer_data, &vb)))
+        if (FAILED(hr = d2d_rt_get_geometry_buffer(render_target, geometry,
+                D2D_GEOMETRY_BUFFER_FILL_VERTICES, &vb)))
         {
             ERR("Failed to create vertex buffer, hr %#x.\n", hr);
-            ID3D10Buffer_Release(ib);
             goto done;
         }
 
         d2d_rt_draw(render_target, D2D_SHAPE_TYPE_TRIANGLE, ib, 3 * geometry->fill.face_count, vb,
                 sizeof(*geometry->fill.vertices), vs_cb, ps_cb, brush, opacity_brush);
-
-        ID3D10Buffer_Release(vb);
-        ID3D10Buffer_Release(ib);
     }
 
     if (geometry->fill.bezier_vertex_count)
     {
-        buffer_desc.ByteWidth = geometry->fill.bezier_vertex_count * sizeof(*geometry->fill.bezier_vertices);
-        buffer_data.pSysMem = geometry->fill.bezier_vertices;
-
-        if (FAILED(hr = ID3D10Device_CreateBuffer(render_target->device, &buffer_desc, &buffer_data, &vb)))
+        if (FAILED(hr = d2d_rt_get_geometry_buffer(render_target, geometry,
+                D2D_GEOMETRY_BUFFER_FILL_BEZIER_VERTICES, &vb)))
         {
             ERR("Failed to create beziers vertex buffer, hr %#x.\n", hr);
             goto done;
@@ -874,8 +982,6 @@ static void d2d_rt_fill_geometry(struct d2d_d3d_render_target *render_target,
 
         d2d_rt_draw(render_target, D2D_SHAPE_TYPE_BEZIER, NULL, geometry->fill.bezier_vertex_count, vb,
                 sizeof(*geometry->fill.bezier_vertices), vs_cb, ps_cb, brush, opacity_brush);
-
-        ID3D10Buffer_Release(vb);
     }
 
 done:
@@ -2703,6 +2809,7 @@ static HRESULT d2d_d3d_render_target_init(struct d2d_d3d_render_target *render_t
 
     render_target->outer_unknown = outer_unknown ? outer_unknown :
             (IUnknown *)&render_target->ID2D1RenderTarget_iface;
+    list_init(&render_target->geometry_buffers);
 
     if (FAILED(hr = IDXGISurface_GetDevice(surface, &IID_ID3D10Device, (void **)&render_target->device)))
     {
@@ -26,6 +26,7 @@
 #define COBJMACROS
 
 #include "dwrite_private.h"
+#include "wine/rbtree.h"
 
 WINE_DEFAULT_DEBUG_CHANNEL(dwrite);
 WINE_DECLARE_DEBUG_CHANNEL(dwrite_file);
@@ -3620,16 +3621,91 @@ static void fontcollection_add_replacements(struct dwrite_fontcollection *collec
     RegCloseKey(hkey);
 }
 
+struct fontfile_key
+{
+    const void *data;
+    UINT32 size;
+};
+
+struct fontfile_enum
+{
+    struct wine_rb_entry entry;
+    IDWriteFontFile *file;
+    struct fontfile_key key;
+};
+
+static int fontfile_enum_compare(const void *k, const struct wine_rb_entry *entry)
+{
+    const struct fontfile_enum *fileenum = WINE_RB_ENTRY_VALUE(entry, const struct fontfile_enum, entry);
+    const struct fontfile_key *key = k;
+
+    if (key->size != fileenum->key.size)
+        return key->size < fileenum->key.size ? -1 : 1;
+    return memcmp(key->data, fileenum->key.data, key->size);
+}
+
+static void fontfile_enum_destroy(struct wine_rb_entry *entry, void *context)
+{
+    struct fontfile_enum *fileenum = WINE_RB_ENTRY_VALUE(entry, struct fontfile_enum, entry);
+
+    IDWriteFontFile_Release(fileenum->file);
+    heap_free(fileenum);
+}
+
+/* Maps every localized name of collection families to the first family using it,
+   same result as collection_find_family() without scanning all families for every face. */
+struct family_name_entry
+{
+    struct wine_rb_entry entry;
+    WCHAR *name;
+    UINT32 index;
+};
+
+static int family_name_compare(const void *key, const struct wine_rb_entry *entry)
+{
+    return strcmpiW(key, WINE_RB_ENTRY_VALUE(entry, const struct family_name_entry, entry)->name);
+}
+
+static void family_name_destroy(struct wine_rb_entry *entry, void *context)
+{
+    struct family_name_entry *name = WINE_RB_ENTRY_VALUE(entry, struct family_name_entry, entry);
+
+    heap_free(name->name);
+    heap_free(name);
+}
+
+static void family_names_add(struct wine_rb_tree *names, IDWriteLocalizedStrings *family_name, UINT32 index)
+{
+    UINT32 i, count = IDWriteLocalizedStrings_GetCount(family_name);
+
+    for (i = 0; i < count; i++) {
+        struct family_name_entry *name;
+        WCHAR buffer[255];
+
+        if (FAILED(IDWriteLocalizedStrings_GetString(family_name, i, buffer, 255)))
+            continue;
+
+        if (wine_rb_get(names, buffer))
+            continue;
+
+        if (!(name = heap_alloc(sizeof(*name))))
+            return;
+
+        if (!(name->name = heap_strdupW(buffer))) {
+            heap_free(name);
+            return;
+        }
+        name->index = index;
+        wine_rb_put(names, name->name, &name->entry);
+    }
+}
+
 HRESULT create_font_collection(IDWriteFactory5 *factory, IDWriteFontFileEnumerator *enumerator, BOOL is_system,
     IDWriteFontCollection1 **ret)
 {
-    struct fontfile_enum {
-        struct list entry;
-        IDWriteFontFile *file;
-    };
-    struct fontfile_enum *fileenum, *fileenum2;
+    struct wine_rb_tree scannedfiles, family_names;
     struct dwrite_fontcollection *collection;
-    struct list scannedfiles;
+    struct fontfile_enum *fileenum;
     BOOL current = FALSE;
     HRESULT hr = S_OK;
     UINT32 i;
@@ -3649,13 +3725,15 @@ HRESULT create_font_collection(IDWriteFactory5 *factory, IDWriteFontFileEnumerat
 
     TRACE("building font collection:\n");
 
-    list_init(&scannedfiles);
+    wine_rb_init(&scannedfiles, fontfile_enum_compare);
+    wine_rb_init(&family_names, family_name_compare);
     while (hr == S_OK) {
         DWRITE_FONT_FACE_TYPE face_type;
         DWRITE_FONT_FILE_TYPE file_type;
-        BOOL supported, same = FALSE;
+        struct fontfile_key key;
         IDWriteFontFile *file;
         UINT32 face_count;
+        BOOL supported;
 
         current = FALSE;
         hr = IDWriteFontFileEnumerator_MoveNext(enumerator, &current);
@@ -3667,12 +3745,9 @@ HRESULT create_font_collection(IDWriteFactory5 *factory, IDWriteFontFileEnumerat
             break;
 
         /* check if we've scanned this file already */
-        LIST_FOR_EACH_ENTRY(fileenum, &scannedfiles, struct fontfile_enum, entry) {
-            if ((same = is_same_fontfile(fileenum->file, file)))
-                break;
-        }
-
-        if (same) {
+        if (FAILED(IDWriteFontFile_GetReferenceKey(file, &key.data, &key.size)))
+            key.data = NULL;
+        else if (wine_rb_get(&scannedfiles, &key)) {
             IDWriteFontFile_Release(file);
             continue;
         }
@@ -3686,14 +3761,18 @@ HRESULT create_font_collection(IDWriteFactory5 *factory, IDWriteFontFileEnumerat
             continue;
         }
 
-        /* add to scanned list */
-        fileenum = heap_alloc(sizeof(*fileenum));
-        fileenum->file = file;
-        list_add_tail(&scannedfiles, &fileenum->entry);
+        /* add to scanned list, files without a reference key can't be matched */
+        fileenum = key.data ? heap_alloc(sizeof(*fileenum)) : NULL;
+        if (fileenum) {
+            fileenum->file = file;
+            fileenum->key = key;
+            wine_rb_put(&scannedfiles, &fileenum->key, &fileenum->entry);
+        }
 
         for (i = 0; i < face_count; i++) {
             IDWriteLocalizedStrings *family_name = NULL;
             struct dwrite_font_data *font_data;
+            struct wine_rb_entry *entry;
             struct fontface_desc desc;
             WCHAR familyW[255];
             UINT32 index;
@@ -3724,9 +3803,10 @@ HRESULT create_font_collection(IDWriteFactory5 *factory, IDWriteFontFileEnumerat
                 continue;
             }
 
-            index = collection_find_family(collection, familyW);
-            if (index != ~0u)
+            if ((entry = wine_rb_get(&family_names, familyW))) {
+                index = WINE_RB_ENTRY_VALUE(entry, struct family_name_entry, entry)->index;
                 hr = fontfamily_add_font(collection->family_data[index], font_data);
+            }
             else {
                 struct dwrite_fontfamily_data *family_data;
 
@@ -3740,6 +3820,8 @@ HRESULT create_font_collection(IDWriteFactory5 *factory, IDWriteFontFileEnumerat
 
                     if (FAILED(hr))
                         release_fontfamily_data(family_data);
+                    else
+                        family_names_add(&family_names, family_name, collection->family_count - 1);
                 }
             }
 
@@ -3748,14 +3830,14 @@ HRESULT create_font_collection(IDWriteFactory5 *factory, IDWriteFontFileEnumerat
             if (FAILED(hr))
                 break;
         }
-    }
 
-    LIST_FOR_EACH_ENTRY_SAFE(fileenum, fileenum2, &scannedfiles, struct fontfile_enum, entry) {
-        IDWriteFontFile_Release(fileenum->file);
-        list_remove(&fileenum->entry);
-        heap_free(fileenum);
+        if (!fileenum)
+            IDWriteFontFile_Release(file);
     }
 
+    wine_rb_destroy(&scannedfiles, fontfile_enum_destroy, NULL);
+    wine_rb_destroy(&family_names, family_name_destroy, NULL);
+
     for (i = 0; i < collection->family_count; i++) {
         fontfamily_add_bold_simulated_face(collection->family_data[i]);
         fontfamily_add_oblique_simulated_face(collection->family_data[i]);
@@ -2517,6 +2517,7 @@ static inline HRESULT return_range(const struct layout_range_header *h, DWRITE_T
 static HRESULT set_layout_range_attr(struct dwrite_textlayout *layout, enum layout_range_attr_kind attr, struct layout_range_attr_value *value)
 {
     struct layout_range_header *cur, *right, *left, *outer;
+    USHORT recompute = RECOMPUTE_EVERYTHING;
     BOOL changed = FALSE;
     struct list *ranges;
     DWRITE_TEXT_RANGE r;
@@ -2525,7 +2526,8 @@ static HRESULT set_layout_range_attr(struct dwrite_textlayout *layout, enum layo
     if (value->range.length == 0)
         return S_OK;
 
-    /* select from ranges lists */
+    /* Select from ranges lists. Decorations and drawing effects only split effective runs,
+       existing analysis and shaping results remain valid for them. */
     switch (attr)
     {
     case LAYOUT_RANGE_ATTR_WEIGHT:
@@ -2541,12 +2543,15 @@ static HRESULT set_layout_range_attr(struct dwrite_textlayout *layout, enum layo
         break;
     case LAYOUT_RANGE_ATTR_UNDERLINE:
         ranges = &layout->underline_ranges;
+        recompute = RECOMPUTE_LINES_AND_OVERHANGS;
         break;
     case LAYOUT_RANGE_ATTR_STRIKETHROUGH:
         ranges = &layout->strike_ranges;
+        recompute = RECOMPUTE_LINES_AND_OVERHANGS;
         break;
     case LAYOUT_RANGE_ATTR_EFFECT:
         ranges = &layout->effects;
+        recompute = RECOMPUTE_LINES_AND_OVERHANGS;
         break;
     case LAYOUT_RANGE_ATTR_SPACING:
         ranges = &layout->spacing;
@@ -2617,7 +2622,7 @@ static HRESULT set_layout_range_attr(struct dwrite_textlayout *layout, enum layo
         list_add_after(&outer->entry, &cur->entry);
         list_add_after(&cur->entry, &right->entry);
 
-        layout->recompute = RECOMPUTE_EVERYTHING;
+        layout->recompute |= recompute;
         return S_OK;
     }
 
@@ -2657,7 +2662,7 @@ done:
     if (changed) {
         struct list *next, *i;
 
-        layout->recompute = RECOMPUTE_EVERYTHING;
+        layout->recompute |= recompute;
         i = list_head(ranges);
         while ((next = list_next(ranges, i))) {
             struct layout_range_header *next_range = LIST_ENTRY(next, struct layout_range_header, entry);
@@ -22,6 +22,7 @@
 
 #include "gdi_private.h"
 #include "dibdrv.h"
+#include "winreg.h"
 
 #include "wine/debug.h"
 
@@ -466,6 +467,307 @@ static int get_overlap( const dib_info *dst, const RECT *dst_rect,
     return ret;
 }
 
+/* by default, operations covering at least that many pixels are split into
+ * horizontal bands that are rendered in parallel on the thread pool */
+#define BAND_MIN_PIXELS (512 * 512)
+#define BAND_MIN_ROWS   32
+#define MAX_BANDS       8
+
+struct band_job
+{
+    SLIST_ENTRY entry;     /* entry in the free jobs list, must be first */
+    void      (*func)( void *ctx, int top, int bottom );
+    void       *ctx;
+    int         top;
+    int         height;
+    int         count;     /* number of bands */
+    LONG        next;      /* next band to render */
+    LONG        pending;   /* number of bands not rendered yet */
+    LONG        refcount;
+    HANDLE      done;      /* auto-reset event signaled once all bands have been rendered */
+};
+
+static SLIST_HEADER free_band_jobs;  /* a zeroed list header is an empty list */
+static int max_bands = -1;
+static ULONGLONG band_min_pixels = BAND_MIN_PIXELS;
+
+static void init_band_config(void)
+{
+    static const WCHAR keyW[] = {'S','o','f','t','w','a','r','e','\\','W','i','n','e','\\',
+                                 'D','I','B',' ','E','n','g','i','n','e',0};
+    static const WCHAR max_bandsW[] = {'M','a','x','B','a','n','d','s',0};
+    static const WCHAR min_pixelsW[] = {'B','a','n','d','M','i','n','P','i','x','e','l','s',0};
+    SYSTEM_INFO info;
+    DWORD type, value, size;
+    int bands;
+    HKEY hkey;
+
+    GetSystemInfo( &info );
+    bands = max( 1, min( info.dwNumberOfProcessors, MAX_BANDS ));
+
+    /* @@ Wine registry key: HKCU\Software\Wine\DIB Engine */
+    if (!RegOpenKeyExW( HKEY_CURRENT_USER, keyW, 0, KEY_QUERY_VALUE, &hkey ))
+    {
+        size = sizeof(value);
+        if (!RegQueryValueExW( hkey, max_bandsW, NULL, &type, (BYTE *)&value, &size ) && type == REG_DWORD)
+            bands = min( value, MAX_BANDS );
+        size = sizeof(value);
+        if (!RegQueryValueExW( hkey, min_pixelsW, NULL, &type, (BYTE *)&value, &size ) && type == REG_DWORD)
+            band_min_pixels = value;
+        RegCloseKey( hkey );
+    }
+    TRACE( "using up to %d bands for operations of at least %s pixels\n",
+           bands, wine_dbgstr_longlong( band_min_pixels ));
+    max_bands = bands;
+}
+
+static struct band_job *alloc_band_job(void)
+{
+    struct band_job *job;
+
+    if ((job = (struct band_job *)InterlockedPopEntrySList( &free_band_jobs ))) return job;
+    if (!(job = HeapAlloc( GetProcessHeap(), 0, sizeof(*job) ))) return NULL;
+    if (!(job->done = CreateEventW( NULL, FALSE, FALSE, NULL )))
+    {
+        HeapFree( GetProcessHeap(), 0, job );
+        return NULL;
+    }
+    return job;
+}
+
+/* jobs and their events are recycled, the event has been reset by the wait */
+static void release_band_job( struct band_job *job )
+{
+    if (InterlockedDecrement( &job->refcount )) return;
+    InterlockedPushEntrySList( &free_band_jobs, &job->entry );
+}
+
+static void render_bands( struct band_job *job )
+{
+    int band;
+
+    while ((band = InterlockedIncrement( &job->next ) - 1) < job->count)
+    {
+        job->func( job->ctx, job->top + band * job->height / job->count,
+                   job->top + (band + 1) * job->height / job->count );
+        if (!InterlockedDecrement( &job->pending )) SetEvent( job->done );
+    }
+}
+
+static void CALLBACK band_worker( TP_CALLBACK_INSTANCE *instance, void *arg )
+{
+    struct band_job *job = arg;
+
+    render_bands( job );
+    release_band_job( job );
+}
+
+/***********************************************************************
+ *           render_in_bands
+ *
+ * Split the rows top to bottom of an operation covering the given number of
+ * pixels into bands and call func on each of them, some of them from thread
+ * pool workers. The calling thread takes part in the rendering, and returns
+ * once all the bands are done. Returns FALSE without calling func if the
+ * operation is too small to be worth splitting, or if banding is disabled.
+ */
+static BOOL render_in_bands( int top, int bottom, ULONGLONG pixels,
+                             void (*func)( void *ctx, int top, int bottom ), void *ctx )
+{
+    struct band_job *job;
+    int i, count;
+
+    if (max_bands == -1) init_band_config();
+    count = min( max_bands, (bottom - top) / BAND_MIN_ROWS );
+    if (count < 2 || pixels < band_min_pixels) return FALSE;
+    if (!(job = alloc_band_job())) return FALSE;
+    job->func     = func;
+    job->ctx      = ctx;
+    job->top      = top;
+    job->height   = bottom - top;
+    job->count    = count;
+    job->next     = 0;
+    job->pending  = count;
+    job->refcount = 1;
+
+    for (i = 1; i < count; i++)
+    {
+        InterlockedIncrement( &job->refcount );
+        if (TrySubmitThreadpoolCallback( band_worker, job, NULL )) continue;
+        InterlockedDecrement( &job->refcount );
+        break;  /* the remaining bands will be rendered by this thread */
+    }
+
+    render_bands( job );
+    WaitForSingleObject( job->done, INFINITE );
+    release_band_job( job );
+    TRACE( "rendered rows %d-%d in %d bands\n", top, bottom, count );
+    return TRUE;
+}
+
+static ULONGLONG get_rects_extent( int count, const RECT *rects, int *top, int *bottom )
+{
+    ULONGLONG pixels = 0;
+    int i;
+
+    *top = INT_MAX;
+    *bottom = INT_MIN;
+    for (i = 0; i < count; i++)
+    {
+        pixels += (ULONGLONG)(rects[i].right - rects[i].left) * (rects[i].bottom - rects[i].top);
+        *top = min( *top, rects[i].top );
+        *bottom = max( *bottom, rects[i].bottom );
+    }
+    return pixels;
+}
+
+static inline BOOL clip_rect_to_band( RECT *dst, const RECT *src, int top, int bottom )
+{
+    *dst = *src;
+    dst->top = max( dst->top, top );
+    dst->bottom = min( dst->bottom, bottom );
+    return dst->top < dst->bottom;
+}
+
+struct solid_rects_params
+{
+    const dib_info *dib;
+    int             count;
+    const RECT     *rects;
+    DWORD           and;
+    DWORD           xor;
+};
+
+static void solid_rects_band( void *ctx, int top, int bottom )
+{
+    const struct solid_rects_params *params = ctx;
+    RECT rc;
+    int i;
+
+    for (i = 0; i < params->count; i++)
+        if (clip_rect_to_band( &rc, &params->rects[i], top, bottom ))
+            params->dib->funcs->solid_rects( params->dib, 1, &rc, params->and, params->xor );
+}
+
+void fill_solid_rects( const dib_info *dib, int count, const RECT *rects, DWORD and, DWORD xor )
+{
+    struct solid_rects_params params;
+    ULONGLONG pixels;
+    int top, bottom;
+
+    params.dib   = dib;
+    params.count = count;
+    params.rects = rects;
+    params.and   = and;
+    params.xor   = xor;
+    pixels = get_rects_extent( count, rects, &top, &bottom );
+    if (!render_in_bands( top, bottom, pixels, solid_rects_band, &params ))
+        dib->funcs->solid_rects( dib, count, rects, and, xor );
+}
+
+struct pattern_rects_params
+{
+    const dib_info      *dib;
+    int                  count;
+    const RECT          *rects;
+    const POINT         *origin;
+    const dib_info      *brush;
+    const rop_mask_bits *bits;
+};
+
+static void pattern_rects_band( void *ctx, int top, int bottom )
+{
+    const struct pattern_rects_params *params = ctx;
+    RECT rc;
+    int i;
+
+    for (i = 0; i < params->count; i++)
+        if (clip_rect_to_band( &rc, &params->rects[i], top, bottom ))
+            params->dib->funcs->pattern_rects( params->dib, 1, &rc, params->origin,
+                                               params->brush, params->bits );
+}
+
+void fill_pattern_rects( const dib_info *dib, int count, const RECT *rects, const POINT *origin,
+                         const dib_info *brush, const rop_mask_bits *bits )
+{
+    struct pattern_rects_params params;
+    ULONGLONG pixels;
+    int top, bottom;
+
+    params.dib    = dib;
+    params.count  = count;
+    params.rects  = rects;
+    params.origin = origin;
+    params.brush  = brush;
+    params.bits   = bits;
+    pixels = get_rects_extent( count, rects, &top, &bottom );
+    if (!render_in_bands( top, bottom, pixels, pattern_rects_band, &params ))
+        dib->funcs->pattern_rects( dib, count, rects, origin, brush, bits );
+}
+
+struct src_rects_params
+{
+    const dib_info *dst;
+    const RECT     *dst_rect;
+    const dib_info *src;
+    const RECT     *src_rect;
+    int             count;
+    const RECT     *rects;
+    int             rop2;
+    BLENDFUNCTION   blend;
+};
+
+static void copy_rects_band( void *ctx, int top, int bottom )
+{
+    const struct src_rects_params *params = ctx;
+    POINT origin;
+    RECT rc;
+    int i;
+
+    for (i = 0; i < params->count; i++)
+    {
+        if (!clip_rect_to_band( &rc, &params->rects[i], top, bottom )) continue;
+        origin.x = params->src_rect->left + rc.left - params->dst_rect->left;
+        origin.y = params->src_rect->top  + rc.top  - params->dst_rect->top;
+        params->dst->funcs->copy_rect( params->dst, &rc, params->src, &origin, params->rop2, 0 );
+    }
+}
+
+/* the source and destination must not overlap */
+static BOOL copy_rects_in_bands( const dib_info *dst, const RECT *dst_rect, const dib_info *src,
+                                 const RECT *src_rect, int count, const RECT *rects, int rop2 )
+{
+    struct src_rects_params params;
+    ULONGLONG pixels;
+    int top, bottom;
+
+    params.dst      = dst;
+    params.dst_rect = dst_rect;
+    params.src      = src;
+    params.src_rect = src_rect;
+    params.count    = count;
+    params.rects    = rects;
+    params.rop2     = rop2;
+    pixels = get_rects_extent( count, rects, &top, &bottom );
+    return render_in_bands( top, bottom, pixels, copy_rects_band, &params );
+}
+
+static void blend_rects_band( void *ctx, int top, int bottom )
+{
+    const struct src_rects_params *params = ctx;
+    POINT origin;
+    RECT rc;
+    int i;
+
+    for (i = 0; i < params->count; i++)
+    {
+        if (!clip_rect_to_band( &rc, &params->rects[i], top, bottom )) continue;
+        origin.x = params->src_rect->left + rc.left - params->dst_rect->left;
+        origin.y = params->src_rect->top  + rc.top  - params->dst_rect->top;
+        params->dst->funcs->blend_rect( params->dst, &rc, params->src, &origin, params->blend );
+    }
+}
+
 static void copy_rect( dib_info *dst, const RECT *dst_rect, const dib_info *src, const RECT *src_rect,
                         const struct clipped_rects *clipped_rects, INT rop2 )
 {
@@ -492,7 +794,7 @@ static void copy_rect( dib_info *dst, const RECT *dst_rect, const dib_info *src,
     case R2_WHITE: xor = ~0u;
         /* fall through */
     case R2_BLACK:
-        dst->funcs->solid_rects( dst, count, rects, and, xor );
+        fill_solid_rects( dst, count, rects, and, xor );
         /* fall through */
     case R2_NOP:
         return;
@@ -543,6 +845,9 @@ static void copy_rect( dib_info *dst, const RECT *dst_rect, const dib_info *src,
     }
     else  /* left to right, top to bottom */
     {
+        if (!overlap && copy_rects_in_bands( dst, dst_rect, src, src_rect, count, rects, rop2 ))
+            return;
+
         for (i = 0; i < count; i++)
         {
             origin.x = src_rect->left + rects[i].left - dst_rect->left;
@@ -589,6 +894,28 @@ static DWORD blend_rect( dib_info *dst, const RECT *dst_rect, const dib_info *sr
     int i;
 
     if (!get_clipped_rects( dst, dst_rect, clip, &clipped_rects )) return ERROR_SUCCESS;
+
+    if (!get_overlap( dst, dst_rect, src, src_rect ))
+    {
+        struct src_rects_params params;
+        ULONGLONG pixels;
+        int top, bottom;
+
+        params.dst      = dst;
+        params.dst_rect = dst_rect;
+        params.src      = src;
+        params.src_rect = src_rect;
+        params.count    = clipped_rects.count;
+        params.rects    = clipped_rects.rects;
+        params.blend    = blend;
+        pixels = get_rects_extent( clipped_rects.count, clipped_rects.rects, &top, &bottom );
+        if (render_in_bands( top, bottom, pixels, blend_rects_band, &params ))
+        {
+            free_clipped_rects( &clipped_rects );
+            return ERROR_SUCCESS;
+        }
+    }
+
     for (i = 0; i < clipped_rects.count; i++)
     {
         origin.x = src_rect->left + clipped_rects.rects[i].left - dst_rect->left;
@@ -678,13 +1005,57 @@ static void get_gradient_triangle_vertices( const GRADIENT_TRIANGLE *tri, const
     bounds->bottom = v[2].y;
 }
 
+struct gradient_rects_params
+{
+    const dib_info  *dib;
+    int              count;
+    const RECT      *rects;
+    const TRIVERTEX *v;
+    int              mode;
+    BOOL             ret;
+};
+
+static void gradient_rects_band( void *ctx, int top, int bottom )
+{
+    struct gradient_rects_params *params = ctx;
+    RECT rc;
+    int i;
+
+    for (i = 0; i < params->count; i++)
+    {
+        if (!clip_rect_to_band( &rc, &params->rects[i], top, bottom )) continue;
+        if (!params->dib->funcs->gradient_rect( params->dib, &rc, params->v, params->mode ))
+        {
+            params->ret = FALSE;
+            break;
+        }
+    }
+}
+
 static BOOL gradient_rect( dib_info *dib, TRIVERTEX *v, int mode, HRGN clip, const RECT *bounds )
 {
     int i;
     struct clipped_rects clipped_rects;
+    struct gradient_rects_params params;
+    ULONGLONG pixels;
+    int top, bottom;
     BOOL ret = TRUE;
 
     if (!get_clipped_rects( dib, bounds, clip, &clipped_rects )) return TRUE;
+
+    params.dib   = dib;
+    params.count = clipped_rects.count;
+    params.rects = clipped_rects.rects;
+    params.v     = v;
+    params.mode  = mode;
+    params.ret   = TRUE;
+    pixels = get_rects_extent( clipped_rects.count, clipped_rects.rects, &top, &bottom );
+    if (render_in_bands( top, bottom, pixels, gradient_rects_band, &params ))
+    {
+        free_clipped_rects( &clipped_rects );
+        return params.ret;
+    }
+
     for (i = 0; i < clipped_rects.count; i++)
     {
         if (!(ret = dib->funcs->gradient_rect( dib, &clipped_rects.rects[i], v, mode ))) break;
@@ -1189,6 +1560,92 @@ static DWORD calc_1d_stretch_params( INT dst_start, INT dst_length, INT dst_vis_
 }
 
 
+struct stretch_rows_params
+{
+    dib_info                    *dst_dib;
+    const dib_info              *src_dib;
+    POINT                        dst_start;
+    POINT                        src_start;
+    const struct stretch_params *v_params;
+    const struct stretch_params *h_params;
+    int                          width;
+    int                          mode;
+    BOOL                         vstretch;
+    void (* row_fn)(const dib_info *dst_dib, const POINT *dst_start,
+                    const dib_info *src_dib, const POINT *src_start,
+                    const struct stretch_params *params, int mode, BOOL keep_dst);
+};
+
+/* render the destination rows between top and bottom; the whole
+ * stretch is walked through to find the matching source rows */
+static void stretch_rows_band( void *ctx, int top, int bottom )
+{
+    const struct stretch_rows_params *params = ctx;
+    const struct stretch_params *v_params = params->v_params;
+    unsigned int length = v_params->length;
+    POINT dst_start = params->dst_start, src_start = params->src_start;
+    int err = v_params->err_start;
+
+    if (params->vstretch)
+    {
+        BOOL need_row = TRUE;
+        RECT last_row, this_row;
+        last_row.left = 0;
+        last_row.right = params->width;
+
+        while (length--)
+        {
+            if (dst_start.y < top || dst_start.y >= bottom)
+                need_row = TRUE;
+            else if (need_row)
+            {
+                params->row_fn( params->dst_dib, &dst_start, params->src_dib, &src_start,
+                                params->h_params, params->mode, FALSE );
+                need_row = FALSE;
+            }
+            else
+            {
+                last_row.top = dst_start.y - v_params->dst_inc;
+                last_row.bottom = last_row.top + 1;
+                this_row = last_row;
+                offset_rect( &this_row, 0, v_params->dst_inc );
+                copy_rect( params->dst_dib, &this_row, params->dst_dib, &last_row, NULL, R2_COPYPEN );
+            }
+
+            if (err > 0)
+            {
+                src_start.y += v_params->src_inc;
+                need_row = TRUE;
+                err += v_params->err_add_1;
+            }
+            else err += v_params->err_add_2;
+            dst_start.y += v_params->dst_inc;
+        }
+    }
+    else
+    {
+        int merged_rows = 0;
+
+        while (length--)
+        {
+            if ((params->mode != STRETCH_DELETESCANS || !merged_rows) &&
+                dst_start.y >= top && dst_start.y < bottom)
+                params->row_fn( params->dst_dib, &dst_start, params->src_dib, &src_start,
+                                params->h_params, params->mode, merged_rows != 0 );
+            merged_rows++;
+
+            if (err > 0)
+            {
+                dst_start.y += v_params->dst_inc;
+                merged_rows = 0;
+                err += v_params->err_add_1;
+            }
+            else err += v_params->err_add_2;
+            src_start.y += v_params->src_inc;
+        }
+    }
+}
+
 DWORD stretch_bitmapinfo( const BITMAPINFO *src_info, void *src_bits, struct bitblt_coords *src,
                           const BITMAPINFO *dst_info, void *dst_bits, struct bitblt_coords *dst,
                           INT mode )
@@ -1198,11 +1655,9 @@ DWORD stretch_bitmapinfo( const BITMAPINFO *src_info, void *src_bits, struct bit
     RECT rect;
     BOOL hstretch, vstretch;
     struct stretch_params v_params, h_params;
-    int err;
+    struct stretch_rows_params params;
+    int height;
     DWORD ret;
-    void (* row_fn)(const dib_info *dst_dib, const POINT *dst_start,
-                    const dib_info *src_dib, const POINT *src_start,
-                    const struct stretch_params *params, int mode, BOOL keep_dst);
 
     TRACE("dst %d, %d - %d x %d visrect %s src %d, %d - %d x %d visrect %s\n",
           dst->x, dst->y, dst->width, dst->height, wine_dbgstr_rect(&dst->visrect),
@@ -1236,64 +1691,22 @@ DWORD stretch_bitmapinfo( const BITMAPINFO *src_info, void *src_bits, struct bit
     dst_start.x -= dst->visrect.left;
     dst_start.y -= dst->visrect.top;
 
-    err = v_params.err_start;
-
-    row_fn = hstretch ? dst_dib.funcs->stretch_row : dst_dib.funcs->shrink_row;
-
-    if (vstretch)
-    {
-        BOOL need_row = TRUE;
-        RECT last_row, this_row;
-        if (hstretch) mode = STRETCH_DELETESCANS;
-        last_row.left = 0;
-        last_row.right = dst->visrect.right - dst->visrect.left;
-
-        while (v_params.length--)
-        {
-            if (need_row)
-            {
-                row_fn( &dst_dib, &dst_start, &src_dib, &src_start, &h_params, mode, FALSE );
-                need_row = FALSE;
-            }
-            else
-            {
-                last_row.top = dst_start.y - v_params.dst_inc;
-                last_row.bottom = last_row.top + 1;
-                this_row = last_row;
-                offset_rect( &this_row, 0, v_params.dst_inc );
-                copy_rect( &dst_dib, &this_row, &dst_dib, &last_row, NULL, R2_COPYPEN );
-            }
-
-            if (err > 0)
-            {
-                src_start.y += v_params.src_inc;
-                need_row = TRUE;
-                err += v_params.err_add_1;
-            }
-            else err += v_params.err_add_2;
-            dst_start.y += v_params.dst_inc;
-        }
-    }
-    else
-    {
-        int merged_rows = 0;
-
-        while (v_params.length--)
-        {
-            if (mode != STRETCH_DELETESCANS || !merged_rows)
-                row_fn( &dst_dib, &dst_start, &src_dib, &src_start, &h_params, mode, merged_rows != 0 );
-            merged_rows++;
-
-            if (err > 0)
-            {
-                dst_start.y += v_params.dst_inc;
-                merged_rows = 0;
-                err += v_params.err_add_1;
-            }
-            else err += v_params.err_add_2;
-            src_start.y += v_params.src_inc;
-        }
-    }
+    if (vstretch && hstretch) mode = STRETCH_DELETESCANS;
+
+    params.dst_dib   = &dst_dib;
+    params.src_dib   = &src_dib;
+    params.dst_start = dst_start;
+    params.src_start = src_start;
+    params.v_params  = &v_params;
+    params.h_params  = &h_params;
+    params.width     = dst->visrect.right - dst->visrect.left;
+    params.mode      = mode;
+    params.vstretch  = vstretch;
+    params.row_fn    = hstretch ? dst_dib.funcs->stretch_row : dst_dib.funcs->shrink_row;
+
+    height = dst->visrect.bottom - dst->visrect.top;
+    if (!render_in_bands( 0, height, (ULONGLONG)params.width * height, stretch_rows_band, &params ))
+        stretch_rows_band( &params, 0, height );
 
     /* update coordinates, the destination rectangle is always stored at 0,0 */
     *src = *dst;
@@ -254,6 +254,10 @@ extern DWORD get_pixel_color( DC *dc, const dib_info *dib, COLORREF color, BOOL
 extern int clip_rect_to_dib( const dib_info *dib, RECT *rc ) DECLSPEC_HIDDEN;
 extern int get_clipped_rects( const dib_info *dib, const RECT *rc, HRGN clip, struct clipped_rects *clip_rects ) DECLSPEC_HIDDEN;
 extern void add_clipped_bounds( dibdrv_physdev *dev, const RECT *rect, HRGN clip ) DECLSPEC_HIDDEN;
+extern void fill_solid_rects( const dib_info *dib, int count, const RECT *rects,
+                              DWORD and, DWORD xor ) DECLSPEC_HIDDEN;
+extern void fill_pattern_rects( const dib_info *dib, int count, const RECT *rects, const POINT *origin,
+                                const dib_info *brush, const rop_mask_bits *bits ) DECLSPEC_HIDDEN;
 extern int clip_line(const POINT *start, const POINT *end, const RECT *clip,
                      const bres_params *params, POINT *pt1, POINT *pt2) DECLSPEC_HIDDEN;
 extern void release_cached_font( struct cached_font *font ) DECLSPEC_HIDDEN;
@@ -26,6 +26,7 @@
 #include "wine/debug.h"
 
 WINE_DEFAULT_DEBUG_CHANNEL(dib);
+WINE_DECLARE_DEBUG_CHANNEL(glyphcache);
 
 struct cached_glyph
 {
@@ -51,6 +52,8 @@ struct cached_font
     LOGFONTW              lf;
     XFORM                 xform;
     UINT                  aa_flags;
+    BOOL                  shared_key_init;
+    ULONGLONG             shared_key;  /* key of the font in the shared glyph cache */
     struct cached_glyph **glyphs[GLYPH_NBTYPES][GLYPH_CACHE_PAGES];
 };
 
@@ -65,6 +68,257 @@ static CRITICAL_SECTION_DEBUG critsect_debug =
 };
 static CRITICAL_SECTION font_cache_cs = { &critsect_debug, -1, 0, 0, 0, 0 };
 
+/* Rendered glyphs are also stored in a cache shared by all the processes of the
+ * session, so that the same glyphs don't need to be rasterized again by every
+ * process. Glyphs are appended to a ring buffer and looked up through a hash
+ * table. Nobody takes a lock: writers reserve their space in the ring buffer
+ * and publish the glyph with a single interlocked update of its bucket, readers
+ * copy the glyph and check that it hasn't been overwritten in the meantime.
+ * Any process can write to the section, so everything read from it is checked
+ * before being used. The statistics are traced on the glyphcache channel. */
+
+#define SHARED_GLYPH_BUCKETS   16384
+#define SHARED_GLYPH_PROBES    8
+#define SHARED_GLYPH_DATA_SIZE (4 * 1024 * 1024)  /* must be a power of 2 */
+#define SHARED_GLYPH_MAX_SIZE  (SHARED_GLYPH_DATA_SIZE / 64)
+#define SHARED_GLYPH_TRACE_MISSES 1024  /* trace the statistics every n misses */
+
+struct shared_glyph
+{
+    ULONGLONG    key;
+    DWORD        size;  /* size of the bits */
+    GLYPHMETRICS metrics;
+    BYTE         bits[1];
+};
+
+/* the layout must be the same for 32-bit and 64-bit processes */
+struct shared_glyph_cache
+{
+    LONG      write_pos;  /* end of the space reserved in the ring buffer */
+    LONG      hits;       /* statistics for the whole session */
+    LONG      misses;
+    LONG      evictions;  /* buckets reused while their glyph was still valid */
+    ULONGLONG buckets[SHARED_GLYPH_BUCKETS];  /* high dword of the glyph key | position, 0 if unused */
+    BYTE      data[SHARED_GLYPH_DATA_SIZE];
+};
+
+static struct shared_glyph_cache *get_shared_glyph_cache(void)
+{
+    static const WCHAR nameW[] = {'_','_','w','i','n','e','_','g','l','y','p','h','_','c','a','c','h','e',0};
+    static struct shared_glyph_cache *shared_cache;
+    static BOOL failed;
+    HANDLE mapping;
+    void *ptr;
+
+    if (shared_cache || failed) return shared_cache;
+
+    if (!(mapping = CreateFileMappingW( INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE,
+                                        0, sizeof(*shared_cache), nameW )))
+    {
+        failed = TRUE;
+        return NULL;
+    }
+    ptr = MapViewOfFile( mapping, FILE_MAP_WRITE, 0, 0, sizeof(*shared_cache) );
+    CloseHandle( mapping );
+    if (!ptr)
+    {
+        failed = TRUE;
+        return NULL;
+    }
+    if (InterlockedCompareExchangePointer( (void **)&shared_cache, ptr, NULL ))
+        UnmapViewOfFile( ptr );
+    return shared_cache;
+}
+
+static ULONGLONG hash_data( ULONGLONG hash, const void *data, SIZE_T size )
+{
+    const BYTE *ptr = data;
+
+    while (size--) hash = (hash ^ *ptr++) * 0x100000001b3ull;  /* FNV-1a */
+    return hash;
+}
+
+static ULONGLONG get_shared_glyph_key( ULONGLONG font_key, UINT index, UINT flags )
+{
+    ULONGLONG key;
+
+    flags &= ETO_GLYPH_INDEX;
+    key = hash_data( font_key, &index, sizeof(index) );
+    key = hash_data( key, &flags, sizeof(flags) );
+    return key;
+}
+
+static inline ULONGLONG make_shared_glyph_bucket( ULONGLONG key, DWORD pos )
+{
+    /* the tag is never 0 so that used buckets can't be mistaken for empty ones */
+    return ((ULONGLONG)((DWORD)(key >> 32) | 1) << 32) | pos;
+}
+
+/* interlocked operations are full barriers, so these also order the accesses to the glyph data */
+static inline ULONGLONG read_shared_glyph_bucket( struct shared_glyph_cache *cache, unsigned int index )
+{
+    return InterlockedCompareExchange64( (LONGLONG *)&cache->buckets[index], 0, 0 );
+}
+
+static inline DWORD get_shared_glyph_write_pos( struct shared_glyph_cache *cache )
+{
+    return InterlockedCompareExchange( &cache->write_pos, 0, 0 );
+}
+
+/* a glyph stored at pos is valid as long as the ring buffer hasn't wrapped around it */
+static inline BOOL is_shared_glyph_valid( struct shared_glyph_cache *cache, DWORD pos )
+{
+    return get_shared_glyph_write_pos( cache ) - pos <= SHARED_GLYPH_DATA_SIZE;
+}
+
+static void count_shared_glyph_miss( struct shared_glyph_cache *cache )
+{
+    LONG misses = InterlockedIncrement( &cache->misses );
+
+    if (misses % SHARED_GLYPH_TRACE_MISSES) return;
+    TRACE_(glyphcache)( "%u hits, %u misses, %u evictions, %u bytes written\n",
+                        (DWORD)cache->hits, (DWORD)misses, (DWORD)cache->evictions,
+                        get_shared_glyph_write_pos( cache ));
+}
+
+static struct cached_glyph *get_shared_glyph( ULONGLONG font_key, UINT index, UINT flags, int bit_count )
+{
+    struct shared_glyph_cache *cache = get_shared_glyph_cache();
+    struct shared_glyph header;
+    struct cached_glyph *glyph;
+    ULONGLONG bucket, key = get_shared_glyph_key( font_key, index, flags );
+    ULONGLONG tag = make_shared_glyph_bucket( key, 0 );
+    DWORD pos, offset;
+    int i;
+
+    if (!cache) return NULL;
+
+    for (i = 0; i < SHARED_GLYPH_PROBES; i++)
+    {
+        bucket = read_shared_glyph_bucket( cache, (key + i) % SHARED_GLYPH_BUCKETS );
+        if ((bucket & ~(ULONGLONG)0xffffffff) != tag) continue;
+        pos = (DWORD)bucket;
+        offset = pos % SHARED_GLYPH_DATA_SIZE;
+        if (offset % 8) continue;
+        if (offset > SHARED_GLYPH_DATA_SIZE - FIELD_OFFSET( struct shared_glyph, bits )) continue;
+        if (!is_shared_glyph_valid( cache, pos )) continue;
+
+        memcpy( &header, cache->data + offset, FIELD_OFFSET( struct shared_glyph, bits ));
+        if (header.key != key) continue;
+        if (header.size > SHARED_GLYPH_MAX_SIZE) continue;
+        if (header.size > SHARED_GLYPH_DATA_SIZE - offset - FIELD_OFFSET( struct shared_glyph, bits )) continue;
+        if (header.size != (ULONGLONG)header.metrics.gmBlackBoxY *
+            ((((ULONGLONG)header.metrics.gmBlackBoxX * bit_count + 31) >> 3) & ~3)) continue;
+
+        if (!(glyph = HeapAlloc( GetProcessHeap(), 0, FIELD_OFFSET( struct cached_glyph, bits[header.size] ))))
+            return NULL;
+        glyph->metrics = header.metrics;
+        memcpy( glyph->bits, cache->data + offset + FIELD_OFFSET( struct shared_glyph, bits ), header.size );
+
+        if (!is_shared_glyph_valid( cache, pos ))  /* overwritten while we were copying it */
+        {
+            HeapFree( GetProcessHeap(), 0, glyph );
+            break;
+        }
+        InterlockedIncrement( &cache->hits );
+        return glyph;
+    }
+    count_shared_glyph_miss( cache );
+    return NULL;
+}
+
+static void add_shared_glyph( ULONGLONG font_key, UINT index, UINT flags, const struct cached_glyph *glyph,
+                              DWORD size )
+{
+    struct shared_glyph_cache *cache = get_shared_glyph_cache();
+    struct shared_glyph *shared;
+    ULONGLONG bucket, key = get_shared_glyph_key( font_key, index, flags );
+    ULONGLONG tag = make_shared_glyph_bucket( key, 0 );
+    DWORD pos, offset, len = (FIELD_OFFSET( struct shared_glyph, bits[size] ) + 7) & ~7;
+    unsigned int slot;
+    int i;
+
+    if (!cache) return;
+    if (len > SHARED_GLYPH_MAX_SIZE) return;  /* don't let huge glyphs flush the cache */
+
+    /* reserve the space first so that readers notice what gets overwritten; if it
+     * straddles the end of the ring buffer, give it up, it's only a cache */
+    pos = InterlockedExchangeAdd( &cache->write_pos, len );
+    offset = pos % SHARED_GLYPH_DATA_SIZE;
+    if (offset % 8 || offset > SHARED_GLYPH_DATA_SIZE - len) return;
+
+    shared = (struct shared_glyph *)(cache->data + offset);
+    shared->key     = key;
+    shared->size    = size;
+    shared->metrics = glyph->metrics;
+    memcpy( shared->bits, glyph->bits, size );
+
+    /* reuse an empty or stale bucket, or the first one if all of them are in use */
+    slot = key % SHARED_GLYPH_BUCKETS;
+    bucket = read_shared_glyph_bucket( cache, slot );
+    for (i = 0; i < SHARED_GLYPH_PROBES; i++)
+    {
+        ULONGLONG cur = read_shared_glyph_bucket( cache, (key + i) % SHARED_GLYPH_BUCKETS );
+
+        if (!cur || (cur & ~(ULONGLONG)0xffffffff) == tag || !is_shared_glyph_valid( cache, (DWORD)cur ))
+        {
+            slot = (key + i) % SHARED_GLYPH_BUCKETS;
+            bucket = cur;
+            break;
+        }
+    }
+
+    /* if somebody else updated the bucket in the meantime, let them have it */
+    if (InterlockedCompareExchange64( (LONGLONG *)&cache->buckets[slot],
+                                      make_shared_glyph_bucket( key, pos ), bucket ) == bucket &&
+        i == SHARED_GLYPH_PROBES)
+        InterlockedIncrement( &cache->evictions );
+}
+
+/* identifies the realized font in the shared glyph cache, 0 if its glyphs can't be shared */
+static ULONGLONG get_shared_font_key( DC *dc, struct cached_font *font )
+{
+    struct font_realization_info info;
+    struct font_fileinfo *fileinfo;
+    ULONGLONG key = 0;
+    DWORD size, err, rasterizer[2];
+
+    if (font->shared_key_init) return font->shared_key;
+
+    rasterizer[0] = WineEngGetRasterizerId();
+    rasterizer[1] = sizeof(void *);
+
+    err = GetLastError();
+    info.size = sizeof(info);
+    if (GetFontRealizationInfo( dc->hSelf, &info ) &&
+        !GetFontFileInfo( info.instance_id, 0, NULL, 0, &size ) &&
+        GetLastError() == ERROR_INSUFFICIENT_BUFFER &&
+        (fileinfo = HeapAlloc( GetProcessHeap(), 0, size )))
+    {
+        /* fonts loaded from memory don't have a file name */
+        if (GetFontFileInfo( info.instance_id, 0, fileinfo, size, &size ) && fileinfo->path[0])
+        {
+            key = hash_data( 0xcbf29ce484222325ull, &fileinfo->writetime, sizeof(fileinfo->writetime) );
+            key = hash_data( key, &fileinfo->size, sizeof(fileinfo->size) );
+            key = hash_data( key, fileinfo->path, strlenW( fileinfo->path ) * sizeof(WCHAR) );
+            key = hash_data( key, &info.face_index, sizeof(info.face_index) );
+            key = hash_data( key, &info.simulations, sizeof(info.simulations) );
+            key = hash_data( key, &font->lf, FIELD_OFFSET( LOGFONTW, lfFaceName ));
+            key = hash_data( key, font->lf.lfFaceName, strlenW( font->lf.lfFaceName ) * sizeof(WCHAR) );
+            key = hash_data( key, &font->xform, sizeof(font->xform) );
+            key = hash_data( key, &font->aa_flags, sizeof(font->aa_flags) );
+            /* 32-bit and 64-bit processes may not use the same FreeType */
+            key = hash_data( key, &rasterizer, sizeof(rasterizer) );
+            if (!key) key = 1;
+        }
+        HeapFree( GetProcessHeap(), 0, fileinfo );
+    }
+    SetLastError( err );
+    font->shared_key = key;
+    font->shared_key_init = TRUE;
+    return key;
+}
+
 
 static BOOL brush_rect( dibdrv_physdev *pdev, dib_brush *brush, const RECT *rect, HRGN clip )
 {
@@ -609,6 +863,7 @@ static struct cached_font *add_cached_font( DC *dc, HFONT hfont, UINT aa_flags )
 
     *ptr = font;
     ptr->ref = 1;
+    ptr->shared_key_init = FALSE;
     memset( ptr->glyphs, 0, sizeof(ptr->glyphs) );
 done:
     list_add_head( &font_cache, &ptr->entry );
@@ -751,9 +1006,14 @@ static struct cached_glyph *cache_glyph_bitmap( DC *dc, struct cached_font *font
     int i, x, y;
     DWORD ret, size;
     BYTE *dst, *src;
-    int pad = 0, stride, bit_count;
+    int pad = 0, stride, bit_count = get_glyph_depth( font->aa_flags );
     GLYPHMETRICS metrics;
     struct cached_glyph *glyph;
+    ULONGLONG font_key = get_shared_font_key( dc, font );
+    UINT shared_index = index;
+
+    if (font_key && (glyph = get_shared_glyph( font_key, index, flags, bit_count )))
+        return add_cached_glyph( font, index, flags, glyph );
 
     if (flags & ETO_GLYPH_INDEX) ggo_flags |= GGO_GLYPH_INDEX;
     indices[0] = index;
@@ -766,7 +1026,6 @@ static struct cached_glyph *cache_glyph_bitmap( DC *dc, struct cached_font *font
     if (ret == GDI_ERROR) return NULL;
     if (!ret) metrics.gmBlackBoxX = metrics.gmBlackBoxY = 0; /* empty glyph */
 
-    bit_count = get_glyph_depth( font->aa_flags );
     stride = get_dib_stride( metrics.gmBlackBoxX, bit_count );
     size = metrics.gmBlackBoxY * stride;
     glyph = HeapAlloc( GetProcessHeap(), 0, FIELD_OFFSET( struct cached_glyph, bits[size] ));
@@ -803,6 +1062,7 @@ static struct cached_glyph *cache_glyph_bitmap( DC *dc, struct cached_font *font
 
 done:
     glyph->metrics = metrics;
+    if (font_key) add_shared_glyph( font_key, shared_index, flags, glyph, size );
     return add_cached_glyph( font, index, flags, glyph );
 }
 
@@ -1191,7 +1451,7 @@ BOOL dibdrv_PatBlt( PHYSDEV dev, struct bitblt_coords *dst, DWORD rop )
     case R2_WHITE: xor = ~0u;
         /* fall through */
     case R2_BLACK:
-        pdev->dib.funcs->solid_rects( &pdev->dib, clipped_rects.count, clipped_rects.rects, and, xor );
+        fill_solid_rects( &pdev->dib, clipped_rects.count, clipped_rects.rects, and, xor );
         /* fall through */
     case R2_NOP:
         break;
@@ -4593,62 +4593,61 @@ static inline BYTE blend_color(BYTE dst, BYTE src, DWORD alpha)
     return (src * alpha + dst * (255 - alpha) + 127) / 255;
 }
 
+/* The 32-bit blending functions below work on two channels at a time, stored
+ * in the two 16-bit lanes of a DWORD (blue and red, then green and alpha).
+ * This divides each lane by 255 with the same rounding as (x + 127) / 255,
+ * which is exact for any lane value up to 255 * 255. */
+static inline DWORD div255_lanes( DWORD val )
+{
+    val += 0x00800080;
+    return ((val + ((val >> 8) & 0x00ff00ff)) >> 8) & 0x00ff00ff;
+}
+
 static inline DWORD blend_argb_constant_alpha( DWORD dst, DWORD src, DWORD alpha )
 {
-    return (blend_color( dst, src, alpha ) |
-            blend_color( dst >> 8, src >> 8, alpha ) << 8 |
-            blend_color( dst >> 16, src >> 16, alpha ) << 16 |
-            blend_color( dst >> 24, src >> 24, alpha ) << 24);
+    DWORD br = (src & 0x00ff00ff) * alpha + (dst & 0x00ff00ff) * (255 - alpha);
+    DWORD ga = ((src >> 8) & 0x00ff00ff) * alpha + ((dst >> 8) & 0x00ff00ff) * (255 - alpha);
+    return div255_lanes( br ) | div255_lanes( ga ) << 8;
 }
 
 static inline DWORD blend_argb_no_src_alpha( DWORD dst, DWORD src, DWORD alpha )
 {
-    return (blend_color( dst, src, alpha ) |
-            blend_color( dst >> 8, src >> 8, alpha ) << 8 |
-            blend_color( dst >> 16, src >> 16, alpha ) << 16 |
-            blend_color( dst >> 24, 255, alpha ) << 24);
+    return blend_argb_constant_alpha( dst, src | 0xff000000, alpha );
 }
 
 static inline DWORD blend_argb( DWORD dst, DWORD src )
 {
-    BYTE b = (BYTE)src;
-    BYTE g = (BYTE)(src >> 8);
-    BYTE r = (BYTE)(src >> 16);
-    DWORD alpha  = (BYTE)(src >> 24);
-    return ((b     + ((BYTE)dst         * (255 - alpha) + 127) / 255) |
-            (g     + ((BYTE)(dst >> 8)  * (255 - alpha) + 127) / 255) << 8 |
-            (r     + ((BYTE)(dst >> 16) * (255 - alpha) + 127) / 255) << 16 |
-            (alpha + ((BYTE)(dst >> 24) * (255 - alpha) + 127) / 255) << 24);
+    DWORD alpha = 255 - (src >> 24);
+    /* the channel sums may overflow for invalid premultiplied data, in which case the
+     * carry is or-ed into the next channel, the lanes leave room for it */
+    DWORD br = (src & 0x00ff00ff) + div255_lanes( (dst & 0x00ff00ff) * alpha );
+    DWORD ga = ((src >> 8) & 0x00ff00ff) + div255_lanes( ((dst >> 8) & 0x00ff00ff) * alpha );
+    return br | ga << 8;
 }
 
 static inline DWORD blend_argb_alpha( DWORD dst, DWORD src, DWORD alpha )
 {
-    BYTE b = ((BYTE)src         * alpha + 127) / 255;
-    BYTE g = ((BYTE)(src >> 8)  * alpha + 127) / 255;
-    BYTE r = ((BYTE)(src >> 16) * alpha + 127) / 255;
-    alpha  = ((BYTE)(src >> 24) * alpha + 127) / 255;
-    return ((b     + ((BYTE)dst         * (255 - alpha) + 127) / 255) |
-            (g     + ((BYTE)(dst >> 8)  * (255 - alpha) + 127) / 255) << 8 |
-            (r     + ((BYTE)(dst >> 16) * (255 - alpha) + 127) / 255) << 16 |
-            (alpha + ((BYTE)(dst >> 24) * (255 - alpha) + 127) / 255) << 24);
+    src = div255_lanes( (src & 0x00ff00ff) * alpha ) | div255_lanes( ((src >> 8) & 0x00ff00ff) * alpha ) << 8;
+    return blend_argb( dst, src );
 }
 
 static inline DWORD blend_rgb( BYTE dst_r, BYTE dst_g, BYTE dst_b, DWORD src, BLENDFUNCTION blend )
 {
+    DWORD dst = dst_b | dst_g << 8 | dst_r << 16;
+
     if (blend.AlphaFormat & AC_SRC_ALPHA)
     {
         DWORD alpha = blend.SourceConstantAlpha;
-        BYTE src_b = ((BYTE)src         * alpha + 127) / 255;
-        BYTE src_g = ((BYTE)(src >> 8)  * alpha + 127) / 255;
-        BYTE src_r = ((BYTE)(src >> 16) * alpha + 127) / 255;
-        alpha      = ((BYTE)(src >> 24) * alpha + 127) / 255;
-        return ((src_b + (dst_b * (255 - alpha) + 127) / 255) |
-                (src_g + (dst_g * (255 - alpha) + 127) / 255) << 8 |
-                (src_r + (dst_r * (255 - alpha) + 127) / 255) << 16);
+        DWORD br, ga;
+
+        br = div255_lanes( (src & 0x00ff00ff) * alpha );
+        ga = div255_lanes( ((src >> 8) & 0x00ff00ff) * alpha );
+        alpha = 255 - (ga >> 16);
+        br += div255_lanes( (dst & 0x00ff00ff) * alpha );
+        ga = (ga & 0xff) + div255_lanes( dst_g * alpha );
+        return br | ga << 8;
     }
-    return (blend_color( dst_b, src, blend.SourceConstantAlpha ) |
-            blend_color( dst_g, src >> 8, blend.SourceConstantAlpha ) << 8 |
-            blend_color( dst_r, src >> 16, blend.SourceConstantAlpha ) << 16);
+    return blend_argb_constant_alpha( dst, src, blend.SourceConstantAlpha ) & 0x00ffffff;
 }
 
 static void blend_rect_8888(const dib_info *dst, const RECT *rc,
@@ -4663,7 +4662,11 @@ static void blend_rect_8888(const dib_info *dst, const RECT *rc,
 	if (blend.SourceConstantAlpha == 255)
 	    for (y = rc->top; y < rc->bottom; y++, dst_ptr += dst->stride / 4, src_ptr += src->stride / 4)
 		for (x = 0; x < rc->right - rc->left; x++)
-		    dst_ptr[x] = blend_argb( dst_ptr[x], src_ptr[x] );
+		{
+		    /* fully opaque and fully transparent pixels are the common case */
+		    if (src_ptr[x] >= 0xff000000) dst_ptr[x] = src_ptr[x];
+		    else if (src_ptr[x]) dst_ptr[x] = blend_argb( dst_ptr[x], src_ptr[x] );
+		}
         else
 	    for (y = rc->top; y < rc->bottom; y++, dst_ptr += dst->stride / 4, src_ptr += src->stride / 4)
 		for (x = 0; x < rc->right - rc->left; x++)
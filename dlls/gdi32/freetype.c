@@ -387,12 +387,6 @@ typedef struct {
     GdiFont *font;
 } CHILD_FONT;
 
-struct font_fileinfo {
-    FILETIME writetime;
-    LARGE_INTEGER size;
-    WCHAR path[1];
-};
-
 struct tagGdiFont {
     struct list entry;
     struct list unused_entry;
@@ -618,6 +612,8 @@ static BOOL get_outline_text_metrics(GdiFont *font);
 static BOOL get_bitmap_text_metrics(GdiFont *font);
 static BOOL get_text_metrics(GdiFont *font, LPTEXTMETRICW ptm);
 static void remove_face_from_cache( Face *face );
+static BOOL prepare_font_cache_update(void);
+static INT AddFontToList(const char *file, void *font_data_ptr, DWORD font_data_size, DWORD flags);
 
 static const WCHAR system_link[] = {'S','o','f','t','w','a','r','e','\\','M','i','c','r','o','s','o','f','t','\\',
                                     'W','i','n','d','o','w','s',' ','N','T','\\',
@@ -1814,6 +1810,8 @@ static void add_face_to_cache(Face *face)
     HKEY hkey_family, hkey_face;
     WCHAR *face_key_name;
 
+    if (!prepare_font_cache_update()) return;
+
     RegCreateKeyExW(hkey_font_cache, face->family->FamilyName, 0,
                     NULL, REG_OPTION_VOLATILE, KEY_ALL_ACCESS, NULL, &hkey_family, NULL);
     if(face->family->EnglishName)
@@ -1863,6 +1861,8 @@ static void remove_face_from_cache( Face *face )
 {
     HKEY hkey_family;
 
+    if (!prepare_font_cache_update()) return;
+
     RegOpenKeyExW( hkey_font_cache, face->family->FamilyName, 0, KEY_ALL_ACCESS, &hkey_family );
 
     if (face->scalable)
@@ -1918,14 +1918,9 @@ static void get_family_names( FT_Face ft_face, WCHAR **name, WCHAR **english, BO
     }
 }
 
-static Family *get_family( FT_Face ft_face, BOOL vertical )
+static Family *get_family( WCHAR *name, WCHAR *english_name )
 {
-    Family *family;
-    WCHAR *name, *english_name;
-
-    get_family_names( ft_face, &name, &english_name, vertical );
-
-    family = find_family_from_name( name );
+    Family *family = find_family_from_name( name );
 
     if (!family)
     {
@@ -1950,6 +1945,674 @@ static Family *get_family( FT_Face ft_face, BOOL vertical )
     return family;
 }
 
+static void add_face_to_list( Face *face, WCHAR *name, WCHAR *english_name, DWORD flags )
+{
+    Family *family = get_family( name, english_name );
+
+    if (strlenW(family->FamilyName) >= LF_FACESIZE)
+    {
+        WARN("Ignoring %s because name is too long\n", debugstr_w(family->FamilyName));
+        release_face( face );
+        release_family( family );
+        return;
+    }
+
+    if (insert_face_in_family_list( face, family ))
+    {
+        if (flags & ADDFONT_ADD_TO_CACHE)
+            add_face_to_cache( face );
+
+        TRACE("Added font %s %s\n", debugstr_w(family->FamilyName),
+              debugstr_w(face->StyleName));
+    }
+    release_face( face );
+    release_family( family );
+}
+
+/****************************************************************
+ * Font catalog
+ *
+ * The catalog is stored in the prefix directory and records the faces
+ * found in every font file while the font list is built, so that the
+ * files that haven't been modified since don't have to be opened
+ * through FreeType again. It is mapped read-only, and rewritten at the
+ * end of init_font_list() if anything changed.
+ *
+ * Its serial number is then stored in the volatile font cache key, and
+ * the other processes rebuild the font list from the catalog instead of
+ * reading the key, as long as nothing modified the key since.
+ */
+
+#define FONT_CATALOG_MAGIC   0x54414346  /* "FCAT" */
+#define FONT_CATALOG_VERSION 2
+
+struct font_catalog_header
+{
+    DWORD magic;
+    DWORD version;
+    DWORD ft_version;    /* FreeType version used to load the faces */
+    DWORD lcid;          /* locale of the family names */
+    DWORD langid;        /* language of the style and full names */
+    DWORD serial;        /* changed every time the catalog is written */
+    DWORD file_count;
+    DWORD face_count;
+    DWORD strings_size;
+};
+
+#define CATALOG_FILE_FAILED 0x01  /* loading fails after the listed faces */
+
+struct font_catalog_file
+{
+    ULONGLONG mtime;
+    ULONGLONG size;
+    DWORD     name;        /* offset of the unix file name in the strings */
+    DWORD     flags;       /* CATALOG_FILE_* flags */
+    DWORD     first_face;
+    DWORD     face_count;
+    DWORD     add_flags;   /* ADDFONT_* flags the file was loaded with */
+    DWORD     order;       /* position of the file in the font list loading order */
+};
+
+#define CATALOG_FACE_BITMAP 0x01  /* not a sfnt, requires ADDFONT_ALLOW_BITMAP */
+
+#define CATALOG_NO_STRING (~0u)
+
+struct font_catalog_face
+{
+    DWORD         flags;       /* CATALOG_FACE_* flags */
+    DWORD         family_name; /* offsets of the names in the strings */
+    DWORD         english_name;
+    DWORD         style_name;
+    DWORD         full_name;
+    FONTSIGNATURE fs;
+    DWORD         ntm_flags;
+    LONG          font_version;
+    LONG          size;
+    LONG          x_ppem;
+    LONG          y_ppem;
+    SHORT         height;
+    SHORT         width;
+    SHORT         internal_leading;
+    WORD          scalable;
+};
+
+struct font_catalog
+{
+    struct font_catalog_file *files;
+    struct font_catalog_face *faces;
+    char                     *strings;
+    DWORD                     file_count;
+    DWORD                     face_count;
+    DWORD                     strings_size;
+    DWORD                     files_alloc;
+    DWORD                     faces_alloc;
+    DWORD                     strings_alloc;
+};
+
+static struct font_catalog old_catalog;   /* catalog mapped from disk */
+static struct font_catalog *new_catalog;  /* catalog being built, if any */
+static void *catalog_view;
+static size_t catalog_view_size;
+static struct font_catalog_file *catalog_file;  /* file whose faces are being recorded */
+static BOOL catalog_modified;
+static BOOL catalog_incomplete;  /* some files couldn't be recorded */
+static BOOL catalog_loading;     /* the font list is being rebuilt from the catalog */
+static DWORD catalog_serial;
+
+static const WCHAR catalog_serial_value[] = {'C','a','t','a','l','o','g',0};
+
+static char *get_font_catalog_path( const char *suffix )
+{
+    static const char nameA[] = "/fontcache";
+    const char *dir = wine_get_config_dir();
+    char *path;
+
+    if (!dir) return NULL;
+    if (!(path = HeapAlloc( GetProcessHeap(), 0, strlen(dir) + sizeof(nameA) + strlen(suffix) )))
+        return NULL;
+    strcpy( path, dir );
+    strcat( path, nameA );
+    strcat( path, suffix );
+    return path;
+}
+
+static BOOL grow_catalog_array( void **array, DWORD *alloc, DWORD count, DWORD size )
+{
+    DWORD new_alloc;
+    void *ptr;
+
+    if (count < *alloc) return TRUE;
+    new_alloc = max( 64, *alloc * 2 );
+    while (new_alloc < count + 1) new_alloc *= 2;
+    if (*array) ptr = HeapReAlloc( GetProcessHeap(), 0, *array, new_alloc * size );
+    else ptr = HeapAlloc( GetProcessHeap(), 0, new_alloc * size );
+    if (!ptr) return FALSE;
+    *array = ptr;
+    *alloc = new_alloc;
+    return TRUE;
+}
+
+/* strings are kept WCHAR aligned, the file names are padded accordingly */
+static DWORD add_catalog_string( struct font_catalog *catalog, const void *str, DWORD size )
+{
+    DWORD offset = catalog->strings_size, len = (size + 1) & ~1;
+
+    if (!str) return CATALOG_NO_STRING;
+    if (catalog->strings_alloc - offset < len)
+    {
+        DWORD new_alloc = max( 4096, catalog->strings_alloc * 2 );
+        char *ptr;
+
+        while (new_alloc - offset < len) new_alloc *= 2;
+        if (catalog->strings) ptr = HeapReAlloc( GetProcessHeap(), 0, catalog->strings, new_alloc );
+        else ptr = HeapAlloc( GetProcessHeap(), 0, new_alloc );
+        if (!ptr) return CATALOG_NO_STRING;
+        catalog->strings = ptr;
+        catalog->strings_alloc = new_alloc;
+    }
+    memcpy( catalog->strings + offset, str, size );
+    if (len > size) catalog->strings[offset + size] = 0;
+    catalog->strings_size += len;
+    return offset;
+}
+
+static inline DWORD add_catalog_stringW( struct font_catalog *catalog, const WCHAR *str )
+{
+    return add_catalog_string( catalog, str, str ? (strlenW( str ) + 1) * sizeof(WCHAR) : 0 );
+}
+
+static inline const WCHAR *get_catalog_stringW( const struct font_catalog *catalog, DWORD offset )
+{
+    if (offset == CATALOG_NO_STRING) return NULL;
+    return (const WCHAR *)(catalog->strings + offset);
+}
+
+static BOOL is_valid_catalog_stringW( const struct font_catalog *catalog, DWORD offset, BOOL optional )
+{
+    if (offset == CATALOG_NO_STRING) return optional;
+    return offset < catalog->strings_size && !(offset & 1);
+}
+
+/* map the catalog stored in the prefix, if it's valid for the current configuration */
+static BOOL map_font_catalog(void)
+{
+    const struct font_catalog_header *header;
+    struct stat st;
+    char *path;
+    void *view;
+    int fd;
+
+    if (!(path = get_font_catalog_path( "" ))) return FALSE;
+    fd = open( path, O_RDONLY );
+    HeapFree( GetProcessHeap(), 0, path );
+    if (fd == -1) return FALSE;
+
+    if (fstat( fd, &st ) == -1 || st.st_size < sizeof(*header) ||
+        (view = mmap( NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0 )) == MAP_FAILED)
+    {
+        close( fd );
+        return FALSE;
+    }
+    close( fd );
+
+    header = view;
+    if (header->magic != FONT_CATALOG_MAGIC || header->version != FONT_CATALOG_VERSION ||
+        header->ft_version != FT_SimpleVersion || header->lcid != GetSystemDefaultLCID() ||
+        header->langid != GetSystemDefaultLangID() ||
+        header->strings_size < sizeof(WCHAR) || (header->strings_size & 1) ||
+        header->file_count > st.st_size / sizeof(struct font_catalog_file) ||
+        header->face_count > st.st_size / sizeof(struct font_catalog_face) ||
+        st.st_size != sizeof(*header) + header->file_count * sizeof(struct font_catalog_file) +
+                      header->face_count * sizeof(struct font_catalog_face) + header->strings_size)
+    {
+        TRACE( "ignoring outdated or invalid font catalog\n" );
+        munmap( view, st.st_size );
+        return FALSE;
+    }
+
+    catalog_view = view;
+    catalog_view_size = st.st_size;
+    catalog_serial = header->serial;
+    old_catalog.files        = (struct font_catalog_file *)(header + 1);
+    old_catalog.faces        = (struct font_catalog_face *)(old_catalog.files + header->file_count);
+    old_catalog.strings      = (char *)(old_catalog.faces + header->face_count);
+    old_catalog.file_count   = header->file_count;
+    old_catalog.face_count   = header->face_count;
+    old_catalog.strings_size = header->strings_size;
+
+    /* make sure that all the strings are terminated */
+    if (*(const WCHAR *)(old_catalog.strings + old_catalog.strings_size - sizeof(WCHAR)))
+        old_catalog.file_count = 0;
+
+    TRACE( "loaded font catalog with %u files and %u faces\n", old_catalog.file_count, old_catalog.face_count );
+    return TRUE;
+}
+
+static void open_font_catalog(void)
+{
+    if (!(new_catalog = HeapAlloc( GetProcessHeap(), HEAP_ZERO_MEMORY, sizeof(*new_catalog) ))) return;
+    map_font_catalog();
+}
+
+struct catalog_file_entry
+{
+    const char *name;
+    const struct font_catalog_file *file;
+    DWORD order;
+};
+
+static int compare_catalog_file_entries( const void *a, const void *b )
+{
+    const struct catalog_file_entry *entry1 = a, *entry2 = b;
+    int ret = strcmp( entry1->name, entry2->name );
+
+    if (!ret) ret = entry1->order - entry2->order;
+    return ret;
+}
+
+/* write the catalog if it changed, return FALSE if the catalog on disk doesn't match the font list */
+static BOOL write_font_catalog(void)
+{
+    struct font_catalog_header header;
+    struct catalog_file_entry *entries;
+    struct font_catalog_file *files;
+    char *path = NULL, *tmp_path = NULL;
+    DWORD i, count = 0;
+    int fd = -1;
+    BOOL ret = FALSE;
+
+    /* sort the files by name for lookups, and drop duplicates */
+    if (!(entries = HeapAlloc( GetProcessHeap(), 0, new_catalog->file_count * sizeof(*entries) )))
+        return FALSE;
+    if (!(files = HeapAlloc( GetProcessHeap(), 0, new_catalog->file_count * sizeof(*files) )))
+    {
+        HeapFree( GetProcessHeap(), 0, entries );
+        return FALSE;
+    }
+    for (i = 0; i < new_catalog->file_count; i++)
+    {
+        entries[i].name  = new_catalog->strings + new_catalog->files[i].name;
+        entries[i].file  = &new_catalog->files[i];
+        entries[i].order = i;
+    }
+    qsort( entries, new_catalog->file_count, sizeof(*entries), compare_catalog_file_entries );
+    for (i = 0; i < new_catalog->file_count; i++)
+    {
+        if (count && !strcmp( entries[i].name, entries[i - 1].name )) continue;
+        files[count] = *entries[i].file;
+        files[count++].order = entries[i].order;
+    }
+    if (!catalog_modified && count == old_catalog.file_count)
+    {
+        /* the files are the same, check that they are still loaded the same way */
+        for (i = 0; i < count; i++)
+            if (files[i].order != old_catalog.files[i].order ||
+                files[i].add_flags != old_catalog.files[i].add_flags) break;
+        if (i == count)
+        {
+            TRACE( "font catalog is up to date\n" );
+            ret = TRUE;
+            goto done;
+        }
+    }
+
+    header.magic        = FONT_CATALOG_MAGIC;
+    header.version      = FONT_CATALOG_VERSION;
+    header.ft_version   = FT_SimpleVersion;
+    header.lcid         = GetSystemDefaultLCID();
+    header.langid       = GetSystemDefaultLangID();
+    header.serial       = catalog_serial + 1;
+    header.file_count   = count;
+    header.face_count   = new_catalog->face_count;
+    if (!new_catalog->strings_size)  /* the string table must not be empty */
+        add_catalog_string( new_catalog, "", 1 );
+    header.strings_size = new_catalog->strings_size;
+
+    if (!(path = get_font_catalog_path( "" ))) goto done;
+    if (!(tmp_path = get_font_catalog_path( ".XXXXXX" ))) goto done;
+    if ((fd = mkstemps( tmp_path, 0 )) == -1) goto done;
+    fchmod( fd, 0644 );
+
+    if (write( fd, &header, sizeof(header) ) != sizeof(header)) goto done;
+    if (write( fd, files, count * sizeof(*files) ) != count * sizeof(*files)) goto done;
+    if (write( fd, new_catalog->faces, new_catalog->face_count * sizeof(*new_catalog->faces) ) !=
+        new_catalog->face_count * sizeof(*new_catalog->faces)) goto done;
+    if (write( fd, new_catalog->strings, new_catalog->strings_size ) != new_catalog->strings_size) goto done;
+    ret = !close( fd );
+    fd = -1;
+    if (ret) ret = !rename( tmp_path, path );
+    if (ret)
+    {
+        catalog_serial = header.serial;
+        TRACE( "wrote font catalog with %u files and %u faces\n", count, header.face_count );
+    }
+    else unlink( tmp_path );
+
+done:
+    if (fd != -1)
+    {
+        close( fd );
+        unlink( tmp_path );
+    }
+    if (!ret && path) WARN( "failed to write the font catalog\n" );
+    HeapFree( GetProcessHeap(), 0, tmp_path );
+    HeapFree( GetProcessHeap(), 0, path );
+    HeapFree( GetProcessHeap(), 0, files );
+    HeapFree( GetProcessHeap(), 0, entries );
+    return ret;
+}
+
+static void unmap_font_catalog(void)
+{
+    if (catalog_view) munmap( catalog_view, catalog_view_size );
+    catalog_view = NULL;
+    memset( &old_catalog, 0, sizeof(old_catalog) );
+}
+
+static void close_font_catalog(void)
+{
+    if (!new_catalog) return;
+
+    /* let the other processes load their font list from the catalog */
+    if (write_font_catalog() && !catalog_incomplete)
+        RegSetValueExW( hkey_font_cache, catalog_serial_value, 0, REG_DWORD,
+                        (const BYTE *)&catalog_serial, sizeof(catalog_serial) );
+
+    unmap_font_catalog();
+    catalog_file = NULL;
+    catalog_modified = FALSE;
+    catalog_incomplete = FALSE;
+
+    HeapFree( GetProcessHeap(), 0, new_catalog->files );
+    HeapFree( GetProcessHeap(), 0, new_catalog->faces );
+    HeapFree( GetProcessHeap(), 0, new_catalog->strings );
+    HeapFree( GetProcessHeap(), 0, new_catalog );
+    new_catalog = NULL;
+}
+
+static int compare_catalog_file_order( const void *a, const void *b )
+{
+    const DWORD *index1 = a, *index2 = b;
+
+    return old_catalog.files[*index1].order - old_catalog.files[*index2].order;
+}
+
+/* called before modifying the font cache key, returns FALSE if the key doesn't need updating */
+static BOOL prepare_font_cache_update(void)
+{
+    /* the key already contains the faces that were recorded in the catalog */
+    if (catalog_loading) return FALSE;
+    /* the catalog no longer matches the key */
+    if (!new_catalog) RegDeleteValueW( hkey_font_cache, catalog_serial_value );
+    return TRUE;
+}
+
+/* rebuild the font list from the catalog, if it matches the font cache key */
+static BOOL load_font_list_from_catalog(void)
+{
+    DWORD i, *order, serial, type, size = sizeof(serial);
+    char *file;
+
+    if (RegQueryValueExW( hkey_font_cache, catalog_serial_value, NULL, &type, (BYTE *)&serial, &size ) ||
+        type != REG_DWORD || !map_font_catalog())
+        return FALSE;
+
+    if (serial != catalog_serial || !old_catalog.file_count ||
+        !(order = HeapAlloc( GetProcessHeap(), 0, old_catalog.file_count * sizeof(*order) )))
+    {
+        TRACE( "font catalog doesn't match the font cache\n" );
+        unmap_font_catalog();
+        return FALSE;
+    }
+
+    /* add the files in the order they were loaded by init_font_list() */
+    for (i = 0; i < old_catalog.file_count; i++) order[i] = i;
+    qsort( order, old_catalog.file_count, sizeof(*order), compare_catalog_file_order );
+
+    catalog_loading = TRUE;
+    for (i = 0; i < old_catalog.file_count; i++)
+    {
+        const struct font_catalog_file *entry = &old_catalog.files[order[i]];
+
+        if (entry->name >= old_catalog.strings_size) continue;
+        file = old_catalog.strings + entry->name;
+        AddFontToList( file, NULL, 0, entry->add_flags );
+    }
+    catalog_loading = FALSE;
+
+    TRACE( "loaded %u font files from the catalog\n", old_catalog.file_count );
+    HeapFree( GetProcessHeap(), 0, order );
+    return TRUE;
+}
+
+static const struct font_catalog_file *find_catalog_file( const char *file )
+{
+    int pos, res, min = 0, max = old_catalog.file_count - 1;
+
+    while (min <= max)
+    {
+        pos = (min + max) / 2;
+        if (old_catalog.files[pos].name >= old_catalog.strings_size) return NULL;
+        if (!(res = strcmp( old_catalog.strings + old_catalog.files[pos].name, file )))
+            return &old_catalog.files[pos];
+        if (res > 0) max = pos - 1;
+        else min = pos + 1;
+    }
+    return NULL;
+}
+
+static BOOL is_valid_catalog_file( const struct font_catalog_file *file )
+{
+    const struct font_catalog_face *face;
+    DWORD i;
+
+    if (file->first_face > old_catalog.face_count) return FALSE;
+    if (file->face_count > old_catalog.face_count - file->first_face) return FALSE;
+    for (i = 0, face = &old_catalog.faces[file->first_face]; i < file->face_count; i++, face++)
+    {
+        if (!is_valid_catalog_stringW( &old_catalog, face->family_name, FALSE )) return FALSE;
+        if (!is_valid_catalog_stringW( &old_catalog, face->english_name, TRUE )) return FALSE;
+        if (!is_valid_catalog_stringW( &old_catalog, face->style_name, FALSE )) return FALSE;
+        if (!is_valid_catalog_stringW( &old_catalog, face->full_name, TRUE )) return FALSE;
+    }
+    return TRUE;
+}
+
+static struct font_catalog_file *begin_catalog_file( const char *file, const struct stat *st, DWORD flags,
+                                                     DWORD add_flags )
+{
+    struct font_catalog_file *entry;
+
+    if (!grow_catalog_array( (void **)&new_catalog->files, &new_catalog->files_alloc,
+                             new_catalog->file_count, sizeof(*new_catalog->files) ) ||
+        (new_catalog->files[new_catalog->file_count].name =
+         add_catalog_string( new_catalog, file, strlen( file ) + 1 )) == CATALOG_NO_STRING)
+    {
+        catalog_incomplete = TRUE;
+        return NULL;
+    }
+    entry = &new_catalog->files[new_catalog->file_count];
+    entry->mtime      = st->st_mtime;
+    entry->size       = st->st_size;
+    entry->flags      = flags;
+    entry->first_face = new_catalog->face_count;
+    entry->face_count = 0;
+    entry->add_flags  = add_flags & ~ADDFONT_VERTICAL_FONT;
+    entry->order      = 0;
+    return entry;
+}
+
+static struct font_catalog_face *add_catalog_face_entry(void)
+{
+    if (!grow_catalog_array( (void **)&new_catalog->faces, &new_catalog->faces_alloc,
+                             new_catalog->face_count, sizeof(*new_catalog->faces) ))
+        return NULL;
+    return &new_catalog->faces[new_catalog->face_count];
+}
+
+/* record a face loaded through FreeType in the catalog being built */
+static void catalog_add_face( const Face *face, const WCHAR *name, const WCHAR *english_name, BOOL bitmap )
+{
+    struct font_catalog_face *entry;
+
+    if (!catalog_file) return;
+    if (!(entry = add_catalog_face_entry()))
+    {
+        catalog_file = NULL;
+        catalog_incomplete = TRUE;
+        return;
+    }
+    entry->flags            = bitmap ? CATALOG_FACE_BITMAP : 0;
+    entry->family_name      = add_catalog_stringW( new_catalog, name );
+    entry->english_name     = add_catalog_stringW( new_catalog, english_name );
+    entry->style_name       = add_catalog_stringW( new_catalog, face->StyleName );
+    entry->full_name        = add_catalog_stringW( new_catalog, face->FullName );
+    entry->fs               = face->fs;
+    entry->ntm_flags        = face->ntmFlags;
+    entry->font_version     = face->font_version;
+    entry->size             = face->size.size;
+    entry->x_ppem           = face->size.x_ppem;
+    entry->y_ppem           = face->size.y_ppem;
+    entry->height           = face->size.height;
+    entry->width            = face->size.width;
+    entry->internal_leading = face->size.internal_leading;
+    entry->scalable         = face->scalable;
+    if (entry->family_name == CATALOG_NO_STRING || entry->style_name == CATALOG_NO_STRING)
+    {
+        catalog_file = NULL;
+        catalog_incomplete = TRUE;
+        return;
+    }
+    new_catalog->face_count++;
+    catalog_file->face_count++;
+}
+
+/* add the file currently being recorded to the catalog */
+static void end_catalog_file( DWORD flags )
+{
+    if (!catalog_file) return;
+    catalog_file->flags |= flags;
+    new_catalog->file_count++;
+    catalog_file = NULL;
+    catalog_modified = TRUE;
+}
+
+static void add_face_from_catalog( const char *file, const struct stat *st, const struct font_catalog_face *entry,
+                                   FT_Long face_index, DWORD flags )
+{
+    Face *face = HeapAlloc( GetProcessHeap(), 0, sizeof(*face) );
+    const WCHAR *english_name = get_catalog_stringW( &old_catalog, entry->english_name );
+    const WCHAR *full_name = get_catalog_stringW( &old_catalog, entry->full_name );
+    WCHAR *name, *english;
+
+    face->refcount = 1;
+    face->StyleName = strdupW( get_catalog_stringW( &old_catalog, entry->style_name ));
+    face->FullName = full_name ? strdupW( full_name ) : NULL;
+    if (flags & ADDFONT_VERTICAL_FONT)
+        face->FullName = prepend_at( face->FullName );
+
+    face->file = towstr( CP_UNIXCP, file );
+    face->dev = st->st_dev;
+    face->ino = st->st_ino;
+    face->font_data_ptr = NULL;
+    face->font_data_size = 0;
+    face->face_index = face_index;
+    face->fs = entry->fs;
+    face->ntmFlags = entry->ntm_flags;
+    face->font_version = entry->font_version;
+    face->scalable = entry->scalable;
+    face->size.height = entry->height;
+    face->size.width = entry->width;
+    face->size.size = entry->size;
+    face->size.x_ppem = entry->x_ppem;
+    face->size.y_ppem = entry->y_ppem;
+    face->size.internal_leading = entry->internal_leading;
+
+    if (!HIWORD( flags )) flags |= ADDFONT_AA_FLAGS( default_aa_flags );
+    face->flags  = flags;
+    face->family = NULL;
+    face->cached_enum_data = NULL;
+
+    name = strdupW( get_catalog_stringW( &old_catalog, entry->family_name ));
+    english = english_name ? strdupW( english_name ) : NULL;
+    if (flags & ADDFONT_VERTICAL_FONT)
+    {
+        name = prepend_at( name );
+        english = prepend_at( english );
+    }
+    add_face_to_list( face, name, english, flags );
+}
+
+/***********************************************************************
+ *      add_font_from_catalog
+ *
+ * Add the faces of a font file from the catalog if it's up to date,
+ * with the same result as AddFontToList(). Returns -1 if the file needs
+ * to be loaded through FreeType, in which case its faces get recorded.
+ */
+static INT add_font_from_catalog( const char *file, DWORD flags )
+{
+    const DWORD FS_DBCS_MASK = FS_JISJAPAN|FS_CHINESESIMP|FS_WANSUNG|FS_CHINESETRAD|FS_JOHAB;
+    const struct font_catalog_file *entry;
+    const struct font_catalog_face *face;
+    struct font_catalog_file *copy;
+    struct stat st;
+    DWORD i;
+    INT ret = 0;
+
+    catalog_file = NULL;
+    if (!catalog_view && !new_catalog) return -1;
+    if (stat( file, &st ) == -1) return -1;
+
+    if (!(entry = find_catalog_file( file )) || entry->mtime != st.st_mtime || entry->size != st.st_size ||
+        !is_valid_catalog_file( entry ))
+    {
+        TRACE( "loading %s\n", debugstr_a(file) );
+        if (new_catalog) catalog_file = begin_catalog_file( file, &st, 0, flags );
+        return -1;
+    }
+
+    /* keep the entry in the new catalog */
+    if (new_catalog && (copy = begin_catalog_file( file, &st, entry->flags, flags )))
+    {
+        for (i = 0, face = &old_catalog.faces[entry->first_face]; i < entry->face_count; i++, face++)
+        {
+            struct font_catalog_face *new_face = add_catalog_face_entry();
+
+            if (!new_face) break;
+            *new_face = *face;
+            new_face->family_name  = add_catalog_stringW( new_catalog, get_catalog_stringW( &old_catalog, face->family_name ));
+            new_face->english_name = add_catalog_stringW( new_catalog, get_catalog_stringW( &old_catalog, face->english_name ));
+            new_face->style_name   = add_catalog_stringW( new_catalog, get_catalog_stringW( &old_catalog, face->style_name ));
+            new_face->full_name    = add_catalog_stringW( new_catalog, get_catalog_stringW( &old_catalog, face->full_name ));
+            if (new_face->family_name == CATALOG_NO_STRING || new_face->style_name == CATALOG_NO_STRING) break;
+            new_catalog->face_count++;
+            copy->face_count++;
+        }
+        if (i == entry->face_count) new_catalog->file_count++;
+        else catalog_incomplete = TRUE;
+    }
+
+    for (i = 0, face = &old_catalog.faces[entry->first_face]; i < entry->face_count; i++, face++)
+    {
+        if ((face->flags & CATALOG_FACE_BITMAP) && !(flags & ADDFONT_ALLOW_BITMAP))
+        {
+            WARN("Ignoring font %s\n", debugstr_a(file));
+            return 0;
+        }
+        add_face_from_catalog( file, &st, face, i, flags );
+        ++ret;
+
+        if (face->fs.fsCsb[0] & FS_DBCS_MASK)
+        {
+            add_face_from_catalog( file, &st, face, i, flags | ADDFONT_VERTICAL_FONT );
+            ++ret;
+        }
+    }
+    if (entry->flags & CATALOG_FILE_FAILED) return 0;
+    return ret;
+}
+
 static inline FT_Fixed get_font_version( FT_Face ft_face )
 {
     FT_Fixed version = 0;
@@ -2138,28 +2801,13 @@ static void AddFaceToList(FT_Face ft_face, const char *file, void *font_data_ptr
                           FT_Long face_index, DWORD flags )
 {
     Face *face;
-    Family *family;
+    WCHAR *name, *english_name;
 
     face = create_face( ft_face, face_index, file, font_data_ptr, font_data_size, flags );
-    family = get_family( ft_face, flags & ADDFONT_VERTICAL_FONT );
-    if (strlenW(family->FamilyName) >= LF_FACESIZE)
-    {
-        WARN("Ignoring %s because name is too long\n", debugstr_w(family->FamilyName));
-        release_face( face );
-        release_family( family );
-        return;
-    }
-
-    if (insert_face_in_family_list( face, family ))
-    {
-        if (flags & ADDFONT_ADD_TO_CACHE)
-            add_face_to_cache( face );
-
-        TRACE("Added font %s %s\n", debugstr_w(family->FamilyName),
-              debugstr_w(face->StyleName));
-    }
-    release_face( face );
-    release_family( family );
+    get_family_names( ft_face, &name, &english_name, flags & ADDFONT_VERTICAL_FONT );
+    if (!(flags & ADDFONT_VERTICAL_FONT))
+        catalog_add_face( face, name, english_name, !FT_IS_SFNT( ft_face ) );
+    add_face_to_list( face, name, english_name, flags );
 }
 
 static FT_Face new_ft_face( const char *file, void *font_data_ptr, DWORD font_data_size,
@@ -2268,17 +2916,33 @@ static INT AddFontToList(const char *file, void *font_data_ptr, DWORD font_data_
     }
 #endif /* HAVE_CARBON_CARBON_H */
 
+    if (file && (ret = add_font_from_catalog( file, flags )) >= 0) return ret;
+    ret = 0;
+
     do {
         const DWORD FS_DBCS_MASK = FS_JISJAPAN|FS_CHINESESIMP|FS_WANSUNG|FS_CHINESETRAD|FS_JOHAB;
         FONTSIGNATURE fs;
 
-        ft_face = new_ft_face( file, font_data_ptr, font_data_size, face_index, flags & ADDFONT_ALLOW_BITMAP );
-        if (!ft_face) return 0;
+        ft_face = new_ft_face( file, font_data_ptr, font_data_size, face_index, TRUE );
+        if (!ft_face)
+        {
+            end_catalog_file( CATALOG_FILE_FAILED );
+            return 0;
+        }
+
+        if (!FT_IS_SFNT( ft_face ) && !(flags & ADDFONT_ALLOW_BITMAP))
+        {
+            WARN("Ignoring font %s/%p\n", debugstr_a(file), font_data_ptr);
+            catalog_file = NULL;  /* depends on the flags, don't record it */
+            pFT_Done_Face(ft_face);
+            return 0;
+        }
 
         if(ft_face->family_name[0] == '.') /* Ignore fonts with names beginning with a dot */
         {
             TRACE("Ignoring %s since its family name begins with a dot\n", debugstr_a(file));
             pFT_Done_Face(ft_face);
+            end_catalog_file( CATALOG_FILE_FAILED );
             return 0;
         }
 
@@ -2296,6 +2960,8 @@ static INT AddFontToList(const char *file, void *font_data_ptr, DWORD font_data_
 	num_faces = ft_face->num_faces;
 	pFT_Done_Face(ft_face);
     } while(num_faces > ++face_index);
+
+    end_catalog_file( 0 );
     return ret;
 }
 
@@ -4190,6 +4856,7 @@ static void init_font_list(void)
     char *unixname;
 
     delete_external_font_keys();
+    open_font_catalog();
 
     /* load the system bitmap fonts */
     load_system_fonts();
@@ -4315,6 +4982,8 @@ static void init_font_list(void)
         }
         RegCloseKey(hkey);
     }
+
+    close_font_catalog();
 }
 
 static BOOL move_to_front(const WCHAR *name)
@@ -4398,7 +5067,7 @@ BOOL WineEngInit(void)
 
     if(disposition == REG_CREATED_NEW_KEY)
         init_font_list();
-    else
+    else if (!load_font_list_from_catalog())
         load_font_list_from_cache(hkey_font_cache);
 
     reorder_font_list();
@@ -4417,6 +5086,17 @@ BOOL WineEngInit(void)
     return TRUE;
 }
 
+/*************************************************************
+ *    WineEngGetRasterizerId
+ *
+ * Identify the FreeType version and rendering configuration, so that
+ * glyphs shared with other processes come from the same rasterizer.
+ */
+DWORD WineEngGetRasterizerId(void)
+{
+    return FT_SimpleVersion | (is_hinting_enabled() << 24) | (is_subpixel_rendering_enabled() << 25);
+}
+
 /* Some fonts have large usWinDescent values, as a result of storing signed short
    in unsigned field. That's probably caused by sTypoDescent vs usWinDescent confusion in
    some font generation tools. */
@@ -8911,8 +9591,6 @@ static const struct gdi_dc_funcs freetype_funcs =
 
 #else /* HAVE_FREETYPE */
 
-struct font_fileinfo;
-
 /*************************************************************************/
 
 BOOL WineEngInit(void)
@@ -8920,6 +9598,11 @@ BOOL WineEngInit(void)
     return FALSE;
 }
 
+DWORD WineEngGetRasterizerId(void)
+{
+    return 0;
+}
+
 INT WineEngAddFontResourceEx(LPCWSTR file, DWORD flags, PVOID pdv)
 {
     FIXME("(%s, %x, %p): stub\n", debugstr_w(file), flags, pdv);
@@ -1960,16 +1960,91 @@ static BOOL REGION_IntersectO(WINEREGION *pReg,  RECT *r1, RECT *r1End,
     return TRUE;
 }
 
+/***********************************************************************
+ *	     REGION_IntersectRectRegion
+ *
+ * Intersect a region with a single rectangle. This gives the same result
+ * as REGION_RegionOp with REGION_IntersectO, but only looks at the bands
+ * that overlap the rectangle vertically.
+ */
+static BOOL REGION_IntersectRectRegion( WINEREGION *newReg, WINEREGION *reg, const RECT *rect )
+{
+    WINEREGION tmp;
+    RECT *r, *rEnd;
+    INT first, last, mid, top, bottom, bandtop, left, right;
+    INT prevBand = 0, curBand;
+
+    /* the bottoms of the rectangles are sorted, so find the overlapping bands with a binary search */
+    first = 0;
+    last = reg->numRects;
+    while (first < last)
+    {
+        mid = (first + last) / 2;
+        if (reg->rects[mid].bottom <= rect->top) first = mid + 1;
+        else last = mid;
+    }
+    last = reg->numRects;
+    for (mid = first; mid < last; )
+    {
+        INT pos = (mid + last) / 2;
+        if (reg->rects[pos].top < rect->bottom) mid = pos + 1;
+        else last = pos;
+    }
+
+    if (!init_region( &tmp, last - first )) return FALSE;
+
+    r = reg->rects + first;
+    rEnd = reg->rects + last;
+    while (r != rEnd)
+    {
+        bandtop = r->top;
+        top = max( r->top, rect->top );
+        bottom = min( r->bottom, rect->bottom );
+        curBand = tmp.numRects;
+
+        for ( ; r != rEnd && r->top == bandtop; r++)
+        {
+            left = max( r->left, rect->left );
+            right = min( r->right, rect->right );
+            if (left < right) add_rect( &tmp, left, top, right, bottom );
+        }
+
+        if (tmp.numRects != curBand)
+            prevBand = REGION_Coalesce( &tmp, prevBand, curBand );
+    }
+
+    move_rects( newReg, &tmp );
+    return TRUE;
+}
+
 /***********************************************************************
  *	     REGION_IntersectRegion
  */
 static BOOL REGION_IntersectRegion(WINEREGION *newReg, WINEREGION *reg1,
 				   WINEREGION *reg2)
 {
+    RECT rect;
+
    /* check for trivial reject */
     if ( (!(reg1->numRects)) || (!(reg2->numRects))  ||
 	(!overlapping(&reg1->extents, &reg2->extents)))
 	newReg->numRects = 0;
+    else if (reg2->numRects == 1)
+    {
+        rect = reg2->extents;
+        if (rect.left <= reg1->extents.left && rect.top <= reg1->extents.top &&
+            rect.right >= reg1->extents.right && rect.bottom >= reg1->extents.bottom)
+            return REGION_CopyRegion( newReg, reg1 );
+        if (!REGION_IntersectRectRegion( newReg, reg1, &rect )) return FALSE;
+    }
+    else if (reg1->numRects == 1)
+    {
+        rect = reg1->extents;
+        if (rect.left <= reg2->extents.left && rect.top <= reg2->extents.top &&
+            rect.right >= reg2->extents.right && rect.bottom >= reg2->extents.bottom)
+            return REGION_CopyRegion( newReg, reg2 );
+        if (!REGION_IntersectRectRegion( newReg, reg2, &rect )) return FALSE;
+    }
     else
 	if (!REGION_RegionOp (newReg, reg1, reg2, REGION_IntersectO, NULL, NULL)) return FALSE;
 
@@ -2072,6 +2147,48 @@ static BOOL REGION_UnionO (WINEREGION *pReg, RECT *r1, RECT *r1End,
 #undef MERGERECT
 }
 
+/***********************************************************************
+ *	     REGION_AppendRegion
+ *
+ * Union of two regions where reg2 lies entirely below reg1. The bands
+ * of reg2 are simply appended to those of reg1, and only the two bands
+ * where the regions meet may need to be coalesced. When newReg is reg1
+ * this is done in place, which keeps building a region one band at a
+ * time from being quadratic.
+ */
+static BOOL REGION_AppendRegion( WINEREGION *newReg, WINEREGION *reg1, WINEREGION *reg2 )
+{
+    WINEREGION tmp, *dst = newReg;
+    INT count = reg1->numRects + reg2->numRects;
+    INT prevBand, curBand = reg1->numRects;
+    RECT extents;
+
+    extents.left = min( reg1->extents.left, reg2->extents.left );
+    extents.top = reg1->extents.top;
+    extents.right = max( reg1->extents.right, reg2->extents.right );
+    extents.bottom = reg2->extents.bottom;
+
+    if (newReg == reg2)
+    {
+        if (!init_region( &tmp, count )) return FALSE;
+        dst = &tmp;
+    }
+    else if (newReg->size < count && !grow_region( newReg, max( count, 2 * newReg->size ) ))
+        return FALSE;
+
+    if (dst != reg1) memcpy( dst->rects, reg1->rects, reg1->numRects * sizeof(RECT) );
+    memcpy( dst->rects + curBand, reg2->rects, reg2->numRects * sizeof(RECT) );
+    dst->numRects = count;
+
+    prevBand = curBand - 1;
+    while (prevBand && dst->rects[prevBand - 1].top == dst->rects[curBand - 1].top) prevBand--;
+    REGION_Coalesce( dst, prevBand, curBand );
+
+    if (dst == &tmp) move_rects( newReg, &tmp );
+    newReg->extents = extents;
+    return TRUE;
+}
+
 /***********************************************************************
  *	     REGION_UnionRegion
  */
@@ -2129,6 +2246,14 @@ static BOOL REGION_UnionRegion(WINEREGION *newReg, WINEREGION *reg1, WINEREGION
 	return ret;
     }
 
+    /*
+     * Regions don't overlap vertically, no need to merge any band
+     */
+    if (reg1->extents.bottom <= reg2->extents.top)
+        return REGION_AppendRegion( newReg, reg1, reg2 );
+    if (reg2->extents.bottom <= reg1->extents.top)
+        return REGION_AppendRegion( newReg, reg2, reg1 );
+
     if ((ret = REGION_RegionOp (newReg, reg1, reg2, REGION_UnionO, REGION_UnionNonO, REGION_UnionNonO)))
     {
         newReg->extents.left = min(reg1->extents.left, reg2->extents.left);
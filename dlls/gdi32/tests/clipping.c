@@ -291,6 +291,117 @@ static void test_ExtCreateRegion(void)
 
 }
 
+static void verify_region_rects(HRGN hrgn, const RECT *rects, DWORD count)
+{
+    union
+    {
+        RGNDATA data;
+        char buf[sizeof(RGNDATAHEADER) + 8 * sizeof(RECT)];
+    } rgn;
+    const RECT *rect;
+    DWORD ret, i;
+
+    ret = GetRegionData(hrgn, sizeof(rgn), &rgn.data);
+    ok(ret == sizeof(rgn.data.rdh) + count * sizeof(RECT), "got %u\n", ret);
+    ok(rgn.data.rdh.nCount == count, "expected %u rects, got %u\n", count, rgn.data.rdh.nCount);
+    if (rgn.data.rdh.nCount != count) return;
+
+    rect = (const RECT *)rgn.data.Buffer;
+    for (i = 0; i < count; i++)
+        ok(EqualRect(&rect[i], &rects[i]), "%u: expected %s, got %s\n", i,
+           wine_dbgstr_rect(&rects[i]), wine_dbgstr_rect(&rect[i]));
+}
+
+static void test_CombineRgn(void)
+{
+    static const RECT band_rects[] =
+    {
+        {  0,  0, 10, 20 }, { 20,  0, 30, 20 },
+        {  0, 20, 30, 30 },
+        { 10, 30, 20, 40 }
+    };
+    static const RECT and_rects[] =
+    {
+        {  5,  5, 10, 20 }, { 20,  5, 25, 20 },
+        {  5, 20, 25, 30 },
+        { 10, 30, 20, 35 }
+    };
+    static const RECT below_rects[] =
+    {
+        {  0,  0, 10, 20 }, { 20,  0, 30, 20 },
+        {  0, 20, 30, 30 },
+        { 10, 30, 20, 50 }
+    };
+    static const RECT above_rects[] =
+    {
+        {  0,-10, 10, 20 }, { 20,-10, 30, 20 },
+        {  0, 20, 30, 30 },
+        { 10, 30, 20, 40 }
+    };
+    static const RECT empty_rect;
+    HRGN hrgn, tmp, dst;
+    unsigned int i;
+    RECT rc;
+    INT ret;
+
+    /* build the region one band at a time */
+    hrgn = CreateRectRgn(0, 0, 0, 0);
+    tmp = CreateRectRgn(0, 0, 0, 0);
+    dst = CreateRectRgn(0, 0, 0, 0);
+    for (i = 0; i < sizeof(band_rects) / sizeof(band_rects[0]); i++)
+    {
+        SetRectRgn(tmp, band_rects[i].left, band_rects[i].top, band_rects[i].right, band_rects[i].bottom);
+        ret = CombineRgn(hrgn, hrgn, tmp, RGN_OR);
+        ok(ret == (i ? COMPLEXREGION : SIMPLEREGION), "%u: got %d\n", i, ret);
+    }
+    verify_region_rects(hrgn, band_rects, 4);
+
+    SetRectRgn(tmp, 5, 5, 25, 35);
+    ret = CombineRgn(dst, hrgn, tmp, RGN_AND);
+    ok(ret == COMPLEXREGION, "got %d\n", ret);
+    verify_region_rects(dst, and_rects, 4);
+    ret = CombineRgn(dst, tmp, hrgn, RGN_AND);
+    ok(ret == COMPLEXREGION, "got %d\n", ret);
+    verify_region_rects(dst, and_rects, 4);
+
+    SetRectRgn(tmp, 12, 32, 18, 38);
+    ret = CombineRgn(dst, hrgn, tmp, RGN_AND);
+    ok(ret == SIMPLEREGION, "got %d\n", ret);
+    SetRect(&rc, 12, 32, 18, 38);
+    verify_region(dst, &rc);
+
+    SetRectRgn(tmp, 10, 0, 20, 20);
+    ret = CombineRgn(dst, hrgn, tmp, RGN_AND);
+    ok(ret == NULLREGION, "got %d\n", ret);
+    verify_region(dst, &empty_rect);
+
+    SetRectRgn(tmp, -5, -5, 35, 45);
+    ret = CombineRgn(dst, tmp, hrgn, RGN_AND);
+    ok(ret == COMPLEXREGION, "got %d\n", ret);
+    verify_region_rects(dst, band_rects, 4);
+
+    /* adjacent bands that line up are merged */
+    SetRectRgn(tmp, 10, 40, 20, 50);
+    ret = CombineRgn(dst, hrgn, tmp, RGN_OR);
+    ok(ret == COMPLEXREGION, "got %d\n", ret);
+    verify_region_rects(dst, below_rects, 4);
+    ret = CombineRgn(dst, tmp, hrgn, RGN_OR);
+    ok(ret == COMPLEXREGION, "got %d\n", ret);
+    verify_region_rects(dst, below_rects, 4);
+
+    SetRectRgn(tmp, 0, -10, 10, 0);
+    ret = CombineRgn(dst, hrgn, tmp, RGN_OR);
+    ok(ret == COMPLEXREGION, "got %d\n", ret);
+    SetRectRgn(tmp, 20, -10, 30, 0);
+    ret = CombineRgn(tmp, dst, tmp, RGN_OR);
+    ok(ret == COMPLEXREGION, "got %d\n", ret);
+    verify_region_rects(tmp, above_rects, 4);
+
+    DeleteObject(hrgn);
+    DeleteObject(tmp);
+    DeleteObject(dst);
+}
+
 static void test_GetClipRgn(void)
 {
     HDC hdc;
@@ -538,6 +649,7 @@ START_TEST(clipping)
 {
     test_GetRandomRgn();
     test_ExtCreateRegion();
+    test_CombineRgn();
     test_GetClipRgn();
     test_memory_dc_clipping();
     test_window_dc_clipping();
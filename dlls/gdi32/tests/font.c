@@ -20,6 +20,7 @@
  */
 
 #include <stdarg.h>
+#include <stdio.h>
 #include <assert.h>
 
 #include "windef.h"
@@ -6679,10 +6680,195 @@ static void test_GetCharWidthI(void)
     ReleaseDC(0, hdc);
 }
 
+static INT CALLBACK count_font_families_proc(const LOGFONTA *lf, const TEXTMETRICA *ntm, DWORD type, LPARAM lparam)
+{
+    (*(int *)lparam)++;
+    return 1;
+}
+
+static int count_font_families(void)
+{
+    HDC hdc = GetDC(0);
+    LOGFONTA lf;
+    int count = 0;
+
+    memset(&lf, 0, sizeof(lf));
+    lf.lfCharSet = DEFAULT_CHARSET;
+    EnumFontFamiliesExA(hdc, &lf, count_font_families_proc, (LPARAM)&count, 0);
+    ReleaseDC(0, hdc);
+    return count;
+}
+
+static void test_font_list_child(int family_count, BOOL wine_test)
+{
+    ok(count_font_families() == family_count, "expected %d font families, got %d\n",
+       family_count, count_font_families());
+    ok(is_truetype_font_installed("wine_test") == wine_test, "font wine_test should%s be enumerated\n",
+       wine_test ? "" : " not");
+}
+
+static void run_font_list_child(BOOL wine_test)
+{
+    PROCESS_INFORMATION info;
+    STARTUPINFOA startup;
+    char cmdline[MAX_PATH + 32];
+    char **argv;
+
+    winetest_get_mainargs(&argv);
+    sprintf(cmdline, "\"%s\" font font_list %d %d", argv[0], count_font_families(), wine_test);
+    memset(&startup, 0, sizeof(startup));
+    startup.cb = sizeof(startup);
+    ok(CreateProcessA(NULL, cmdline, NULL, NULL, FALSE, 0, NULL, NULL, &startup, &info),
+       "CreateProcess error %d\n", GetLastError());
+    winetest_wait_child_process(info.hProcess);
+    CloseHandle(info.hProcess);
+    CloseHandle(info.hThread);
+}
+
+/* new processes must see the same font list, including the public fonts added since */
+static void test_font_list_in_new_process(void)
+{
+    char ttf_name[MAX_PATH];
+    BOOL ret;
+
+    if (!pAddFontResourceExA || !pRemoveFontResourceExA)
+    {
+        win_skip("AddFontResourceExA is not available on this platform\n");
+        return;
+    }
+
+    run_font_list_child(FALSE);
+
+    if (!write_ttf_file("wine_test.ttf", ttf_name))
+    {
+        skip("Failed to create ttf file for testing\n");
+        return;
+    }
+
+    ret = pAddFontResourceExA(ttf_name, 0, 0);
+    ok(ret, "AddFontResourceEx() error %d\n", GetLastError());
+    run_font_list_child(TRUE);
+
+    ret = pRemoveFontResourceExA(ttf_name, 0, 0);
+    ok(ret, "RemoveFontResourceEx() error %d\n", GetLastError());
+    run_font_list_child(FALSE);
+
+    DeleteFileA(ttf_name);
+}
+
+static DWORD get_text_checksum(BYTE quality, LONG escapement)
+{
+    static const char text[] = "Shared glyphs 0123456789";
+    BITMAPINFO bmi;
+    HBITMAP bitmap, old_bitmap;
+    HFONT hfont, old_hfont;
+    LOGFONTA lf;
+    DWORD *bits, checksum = 0;
+    HDC hdc;
+    int i;
+
+    memset(&bmi, 0, sizeof(bmi));
+    bmi.bmiHeader.biSize = sizeof(bmi.bmiHeader);
+    bmi.bmiHeader.biWidth = 256;
+    bmi.bmiHeader.biHeight = -128;
+    bmi.bmiHeader.biPlanes = 1;
+    bmi.bmiHeader.biBitCount = 32;
+    bmi.bmiHeader.biCompression = BI_RGB;
+
+    hdc = CreateCompatibleDC(0);
+    bitmap = CreateDIBSection(hdc, &bmi, DIB_RGB_COLORS, (void **)&bits, NULL, 0);
+    ok(bitmap != NULL, "CreateDIBSection failed\n");
+    old_bitmap = SelectObject(hdc, bitmap);
+
+    memset(&lf, 0, sizeof(lf));
+    lf.lfHeight = -20;
+    lf.lfEscapement = lf.lfOrientation = escapement;
+    lf.lfQuality = quality;
+    lf.lfCharSet = ANSI_CHARSET;
+    strcpy(lf.lfFaceName, "Tahoma");
+    hfont = CreateFontIndirectA(&lf);
+    old_hfont = SelectObject(hdc, hfont);
+
+    PatBlt(hdc, 0, 0, 256, 128, WHITENESS);
+    TextOutA(hdc, 8, 100, text, sizeof(text) - 1);
+
+    for (i = 0; i < 256 * 128; i++) checksum = (checksum << 5 | checksum >> 27) ^ bits[i];
+
+    SelectObject(hdc, old_hfont);
+    DeleteObject(hfont);
+    SelectObject(hdc, old_bitmap);
+    DeleteObject(bitmap);
+    DeleteDC(hdc);
+    return checksum;
+}
+
+static const struct
+{
+    BYTE quality;
+    LONG escapement;
+} text_checksum_tests[] =
+{
+    { NONANTIALIASED_QUALITY, 0 },
+    { ANTIALIASED_QUALITY, 0 },
+    { ANTIALIASED_QUALITY, 300 },
+};
+
+static void test_text_checksums_child(char **checksums)
+{
+    int i;
+
+    for (i = 0; i < sizeof(text_checksum_tests) / sizeof(text_checksum_tests[0]); i++)
+    {
+        DWORD expected = strtoul(checksums[i], NULL, 16);
+        DWORD checksum = get_text_checksum(text_checksum_tests[i].quality, text_checksum_tests[i].escapement);
+        ok(checksum == expected, "%d: expected %08x, got %08x\n", i, expected, checksum);
+    }
+}
+
+/* glyphs rendered by another process must give the same text, whether or not they are shared */
+static void test_text_in_new_process(void)
+{
+    PROCESS_INFORMATION info;
+    STARTUPINFOA startup;
+    char cmdline[MAX_PATH + 64], *p;
+    char **argv;
+    int i;
+
+    winetest_get_mainargs(&argv);
+    p = cmdline + sprintf(cmdline, "\"%s\" font text", argv[0]);
+    for (i = 0; i < sizeof(text_checksum_tests) / sizeof(text_checksum_tests[0]); i++)
+        p += sprintf(p, " %08x", get_text_checksum(text_checksum_tests[i].quality,
+                                                   text_checksum_tests[i].escapement));
+
+    memset(&startup, 0, sizeof(startup));
+    startup.cb = sizeof(startup);
+    ok(CreateProcessA(NULL, cmdline, NULL, NULL, FALSE, 0, NULL, NULL, &startup, &info),
+       "CreateProcess error %d\n", GetLastError());
+    winetest_wait_child_process(info.hProcess);
+    CloseHandle(info.hProcess);
+    CloseHandle(info.hThread);
+}
+
 START_TEST(font)
 {
+    char **argv;
+    int argc;
+
     init();
 
+    argc = winetest_get_mainargs(&argv);
+    if (argc >= 5 && !strcmp(argv[2], "font_list"))
+    {
+        test_font_list_child(atoi(argv[3]), atoi(argv[4]));
+        return;
+    }
+    if (argc >= 3 + sizeof(text_checksum_tests) / sizeof(text_checksum_tests[0]) &&
+        !strcmp(argv[2], "text"))
+    {
+        test_text_checksums_child(argv + 3);
+        return;
+    }
+
     test_stock_fonts();
     test_logfont();
     test_bitmap_font();
@@ -6742,6 +6928,8 @@ START_TEST(font)
     test_fake_bold_font();
     test_bitmap_font_glyph_index();
     test_GetCharWidthI();
+    test_font_list_in_new_process();
+    test_text_in_new_process();
 
     /* These tests should be last test until RemoveFontResource
      * is properly implemented.
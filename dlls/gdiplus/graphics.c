@@ -529,6 +529,13 @@ static ARGB blend_colors(ARGB start, ARGB end, REAL position)
 
     pos = gdip_round(position * 0xff);
 
+    /* Fast paths for flat areas and positions at either end; these give the
+     * same result as the general blend below. */
+    if (start == end || pos == 0)
+        return (start >> 24) ? start : 0;
+    if (pos == 0xff)
+        return (end >> 24) ? end : 0;
+
     start_a = ((start >> 24) & 0xff) * (pos ^ 0xff);
     end_a = ((end >> 24) & 0xff) * pos;
 
@@ -960,14 +967,31 @@ static ARGB resample_bitmap_pixel(GDIPCONST GpRect *src_rect, LPBYTE bits, UINT
             return sample_bitmap_pixel(src_rect, bits, width, height,
                 leftx, topy, attributes);
 
-        topleft = sample_bitmap_pixel(src_rect, bits, width, height,
-            leftx, topy, attributes);
-        topright = sample_bitmap_pixel(src_rect, bits, width, height,
-            rightx, topy, attributes);
-        bottomleft = sample_bitmap_pixel(src_rect, bits, width, height,
-            leftx, bottomy, attributes);
-        bottomright = sample_bitmap_pixel(src_rect, bits, width, height,
-            rightx, bottomy, attributes);
+        if (leftx >= src_rect->X && topy >= src_rect->Y &&
+            rightx < src_rect->X + src_rect->Width && bottomy < src_rect->Y + src_rect->Height &&
+            leftx >= 0 && topy >= 0 && rightx < width && bottomy < height)
+        {
+            /* All four pixels are inside the image, so no wrapping is needed
+             * and we can read them directly. */
+            const ARGB *row = (const ARGB *)bits + (leftx - src_rect->X) + (topy - src_rect->Y) * src_rect->Width;
+
+            topleft = row[0];
+            topright = row[rightx - leftx];
+            row += (bottomy - topy) * src_rect->Width;
+            bottomleft = row[0];
+            bottomright = row[rightx - leftx];
+        }
+        else
+        {
+            topleft = sample_bitmap_pixel(src_rect, bits, width, height,
+                leftx, topy, attributes);
+            topright = sample_bitmap_pixel(src_rect, bits, width, height,
+                rightx, topy, attributes);
+            bottomleft = sample_bitmap_pixel(src_rect, bits, width, height,
+                leftx, bottomy, attributes);
+            bottomright = sample_bitmap_pixel(src_rect, bits, width, height,
+                rightx, bottomy, attributes);
+        }
 
         x_offset = point->X - leftxf;
         top = blend_colors(topleft, topright, x_offset);
@@ -1286,7 +1310,7 @@ static GpStatus brush_fill_pixels(GpGraphics *graphics, GpBrush *brush,
                 {
                     GpPointF point;
                     point.X = draw_points[0].X + x * x_dx + y * y_dx;
-                    point.Y = draw_points[0].Y + y * x_dy + y * y_dy;
+                    point.Y = draw_points[0].Y + x * x_dy + y * y_dy;
 
                     argb_pixels[x + y*cdwStride] = resample_bitmap_pixel(
                         &src_area, fill->bitmap_bits, bitmap->width, bitmap->height,
@@ -3053,23 +3077,26 @@ GpStatus WINGDIPAPI GdipDrawImagePointsRect(GpGraphics *graphics, GpImage *image
                 y_dx = dst_to_src_points[2].X - dst_to_src_points[0].X;
                 y_dy = dst_to_src_points[2].Y - dst_to_src_points[0].Y;
 
-                for (x=dst_area.left; x<dst_area.right; x++)
+                /* Walk the destination in row order so that both buffers are
+                 * accessed sequentially. */
+                for (y=dst_area.top; y<dst_area.bottom; y++)
                 {
-                    for (y=dst_area.top; y<dst_area.bottom; y++)
+                    ARGB *dst_color = (ARGB*)(dst_data + dst_stride * (y - dst_area.top));
+
+                    for (x=dst_area.left; x<dst_area.right; x++)
                     {
                         GpPointF src_pointf;
-                        ARGB *dst_color;
 
                         src_pointf.X = dst_to_src_points[0].X + x * x_dx + y * y_dx;
                         src_pointf.Y = dst_to_src_points[0].Y + x * x_dy + y * y_dy;
 
-                        dst_color = (ARGB*)(dst_data + dst_stride * (y - dst_area.top) + sizeof(ARGB) * (x - dst_area.left));
-
                         if (src_pointf.X >= srcx && src_pointf.X < srcx + srcwidth && src_pointf.Y >= srcy && src_pointf.Y < srcy+srcheight)
                             *dst_color = resample_bitmap_pixel(&src_area, src_data, bitmap->width, bitmap->height, &src_pointf,
                                                                imageAttributes, interpolation, offset_mode);
                         else
                             *dst_color = 0;
+
+                        dst_color++;
                     }
                 }
             }
@@ -284,6 +284,83 @@ static void test_texturewrap(void)
     ReleaseDC(0, hdc);
 }
 
+static void test_texture_fill(void)
+{
+    static const ARGB texels[2][2] =
+    {
+        { 0xffff0000, 0xff00ff00 },
+        { 0xff0000ff, 0xffffffff },
+    };
+    static const struct
+    {
+        REAL m11, m12, m21, m22;
+        struct
+        {
+            INT x, y;
+            ARGB color;
+        } pixels[4];
+    } tests[] =
+    {
+        /* scaled by 4 */
+        { 4.0, 0.0, 0.0, 4.0, {{ 2, 2, 0xffff0000 }, { 6, 2, 0xff00ff00 }, { 2, 6, 0xff0000ff }, { 6, 6, 0xffffffff }}},
+        /* scaled by 4 and rotated by 90 degrees */
+        { 0.0, 4.0, -4.0, 0.0, {{ 2, 2, 0xff0000ff }, { 6, 2, 0xffff0000 }, { 2, 6, 0xffffffff }, { 6, 6, 0xff00ff00 }}},
+        /* scaled by 4 and sheared horizontally */
+        { 4.0, 0.0, 4.0, 4.0, {{ 5, 2, 0xffff0000 }, { 9, 2, 0xff00ff00 }, { 7, 6, 0xff0000ff }, { 11, 6, 0xffffffff }}},
+    };
+    GpStatus status;
+    GpTexture *texture;
+    GpGraphics *graphics;
+    GpBitmap *bitmap, *texture_bitmap;
+    GpMatrix *matrix;
+    ARGB color;
+    int i, j;
+
+    status = GdipCreateBitmapFromScan0(2, 2, 0, PixelFormat32bppARGB, NULL, &texture_bitmap);
+    expect(Ok, status);
+    for (i = 0; i < 2; i++)
+        for (j = 0; j < 2; j++)
+        {
+            status = GdipBitmapSetPixel(texture_bitmap, j, i, texels[i][j]);
+            expect(Ok, status);
+        }
+
+    status = GdipCreateBitmapFromScan0(16, 16, 0, PixelFormat32bppARGB, NULL, &bitmap);
+    expect(Ok, status);
+    status = GdipGetImageGraphicsContext((GpImage*)bitmap, &graphics);
+    expect(Ok, status);
+    status = GdipSetInterpolationMode(graphics, InterpolationModeNearestNeighbor);
+    expect(Ok, status);
+
+    for (i = 0; i < sizeof(tests) / sizeof(tests[0]); i++)
+    {
+        status = GdipCreateTexture((GpImage*)texture_bitmap, WrapModeTile, &texture);
+        expect(Ok, status);
+        status = GdipCreateMatrix2(tests[i].m11, tests[i].m12, tests[i].m21, tests[i].m22, 0.0, 0.0, &matrix);
+        expect(Ok, status);
+        status = GdipSetTextureTransform(texture, matrix);
+        expect(Ok, status);
+
+        status = GdipFillRectangleI(graphics, (GpBrush*)texture, 0, 0, 16, 16);
+        expect(Ok, status);
+
+        for (j = 0; j < 4; j++)
+        {
+            status = GdipBitmapGetPixel(bitmap, tests[i].pixels[j].x, tests[i].pixels[j].y, &color);
+            expect(Ok, status);
+            ok(color == tests[i].pixels[j].color, "%d: pixel %d,%d: expected %08x, got %08x\n", i,
+               tests[i].pixels[j].x, tests[i].pixels[j].y, tests[i].pixels[j].color, color);
+        }
+
+        GdipDeleteMatrix(matrix);
+        GdipDeleteBrush((GpBrush*)texture);
+    }
+
+    GdipDeleteGraphics(graphics);
+    GdipDisposeImage((GpImage*)bitmap);
+    GdipDisposeImage((GpImage*)texture_bitmap);
+}
+
 static void test_gradientgetrect(void)
 {
     GpLineGradient *brush;
@@ -1289,6 +1366,7 @@ START_TEST(brush)
     test_getgamma();
     test_transform();
     test_texturewrap();
+    test_texture_fill();
     test_gradientgetrect();
     test_lineblend();
     test_linelinearblend();
@@ -1063,7 +1063,8 @@ static NTSTATUS stat_mapping_file( struct file_view *view, struct stat *st )
  * Map an executable (PE format) image into memory.
  */
 static NTSTATUS map_image( HANDLE hmapping, int fd, char *base, SIZE_T total_size, SIZE_T mask,
-                           SIZE_T header_size, int shared_fd, HANDLE dup_mapping, unsigned int map_vprot, PVOID *addr_ptr )
+                           SIZE_T header_size, int shared_fd, int cache_fd, HANDLE dup_mapping,
+                           unsigned int map_vprot, PVOID *addr_ptr )
 {
     IMAGE_DOS_HEADER *dos;
     IMAGE_NT_HEADERS *nt;
@@ -1072,7 +1073,7 @@ static NTSTATUS map_image( HANDLE hmapping, int fd, char *base, SIZE_T total_siz
     IMAGE_DATA_DIRECTORY *imports;
     NTSTATUS status = STATUS_CONFLICTING_ADDRESSES;
     int i;
-    off_t pos;
+    off_t pos, cache_pos;
     sigset_t sigset;
     struct stat st;
     struct file_view *view = NULL;
@@ -1152,7 +1153,7 @@ static NTSTATUS map_image( HANDLE hmapping, int fd, char *base, SIZE_T total_siz
 
     /* map all the sections */
 
-    for (i = pos = 0; i < nt->FileHeader.NumberOfSections; i++, sec++)
+    for (i = pos = cache_pos = 0; i < nt->FileHeader.NumberOfSections; i++, sec++)
     {
         static const SIZE_T sector_align = 0x1ff;
         SIZE_T map_size, file_start, file_size, end;
@@ -1213,14 +1214,39 @@ static NTSTATUS map_image( HANDLE hmapping, int fd, char *base, SIZE_T total_siz
 
         if (!sec->PointerToRawData || !file_size) continue;
 
-        /* Note: if the section is not aligned properly map_file_into_view will magically
-         *       fall back to read(), so we don't need to check anything here.
-         */
         end = file_start + file_size;
         if (sec->PointerToRawData >= st.st_size ||
             end > ((st.st_size + sector_align) & ~sector_align) ||
-            end < file_start ||
-            map_file_into_view( view, fd, sec->VirtualAddress, file_size, file_start,
+            end < file_start)
+        {
+            ERR_(module)( "Could not map section %.8s, file probably truncated\n", sec->Name );
+            goto error;
+        }
+
+        /* the server keeps a page-aligned copy of sections that are not aligned in the file,
+         * map it copy-on-write so that the pages are shared with other processes */
+        /* this must be kept in sync with is_section_cached() in the server */
+        if (file_start & page_mask)
+        {
+            cache_pos += map_size;
+            if (cache_fd != -1)
+            {
+                TRACE_(module)( "mapping section %.8s from image cache off %x size %lx\n",
+                                sec->Name, (int)(cache_pos - map_size), map_size );
+                if (map_file_into_view( view, cache_fd, sec->VirtualAddress, map_size, cache_pos - map_size,
+                                        VPROT_COMMITTED | VPROT_READ | VPROT_WRITECOPY, FALSE ) != STATUS_SUCCESS)
+                {
+                    ERR_(module)( "Could not map cached section %.8s\n", sec->Name );
+                    goto error;
+                }
+                continue;
+            }
+        }
+
+        /* Note: if the section is not aligned properly map_file_into_view will magically
+         *       fall back to read(), so we don't need to check anything here.
+         */
+        if (map_file_into_view( view, fd, sec->VirtualAddress, file_size, file_start,
                                 VPROT_COMMITTED | VPROT_READ | VPROT_WRITECOPY,
                                 !dup_mapping ) != STATUS_SUCCESS)
         {
@@ -2541,7 +2567,8 @@ NTSTATUS WINAPI NtMapViewOfSection( HANDLE handle, HANDLE process, PVOID *addr_p
     unsigned int map_vprot, vprot, sec_flags;
     struct file_view *view;
     pe_image_info_t image_info;
-    HANDLE dup_mapping, shared_file;
+    HANDLE dup_mapping, shared_file, cache_file;
+    int shared_fd = -1, shared_needs_close = 0, cache_fd = -1, cache_needs_close = 0;
     LARGE_INTEGER offset;
     sigset_t sigset;
 
@@ -2623,6 +2650,7 @@ NTSTATUS WINAPI NtMapViewOfSection( HANDLE handle, HANDLE process, PVOID *addr_p
         full_size   = reply->size;
         dup_mapping = wine_server_ptr_handle( reply->mapping );
         shared_file = wine_server_ptr_handle( reply->shared_file );
+        cache_file  = wine_server_ptr_handle( reply->cache_file );
     }
     SERVER_END_REQ;
     if (res) return res;
@@ -2648,20 +2676,24 @@ NTSTATUS WINAPI NtMapViewOfSection( HANDLE handle, HANDLE process, PVOID *addr_p
         }
         if (shared_file)
         {
-            int shared_fd, shared_needs_close;
-
-            if ((res = server_get_unix_fd( shared_file, FILE_READ_DATA|FILE_WRITE_DATA,
-                                           &shared_fd, &shared_needs_close, NULL, NULL ))) goto done;
-            res = map_image( handle, unix_handle, base, size, mask, image_info.header_size,
-                             shared_fd, dup_mapping, map_vprot, addr_ptr );
-            if (shared_needs_close) close( shared_fd );
+            res = server_get_unix_fd( shared_file, FILE_READ_DATA|FILE_WRITE_DATA,
+                                      &shared_fd, &shared_needs_close, NULL, NULL );
             close_handle( shared_file );
         }
-        else
+        if (cache_file)
         {
-            res = map_image( handle, unix_handle, base, size, mask, image_info.header_size,
-                             -1, dup_mapping, map_vprot, addr_ptr );
+            /* the cache is optional, map the image directly if it can't be used */
+            if (server_get_unix_fd( cache_file, FILE_READ_DATA, &cache_fd, &cache_needs_close, NULL, NULL ))
+                cache_fd = -1;
+            close_handle( cache_file );
         }
+        if (!res)
+            res = map_image( handle, unix_handle, base, size, mask, image_info.header_size,
+                             shared_fd, cache_fd, dup_mapping, map_vprot, addr_ptr );
+        else if (dup_mapping)
+            close_handle( dup_mapping );
+        if (shared_needs_close) close( shared_fd );
+        if (cache_needs_close) close( cache_fd );
         if (needs_close) close( unix_handle );
         if (res >= 0) *size_ptr = size;
         return res;
@@ -171,28 +171,28 @@ static void update_mouse_coords( INPUT *input )
  */
 UINT WINAPI SendInput( UINT count, LPINPUT inputs, int size )
 {
-    UINT i;
+    INPUT buffer[64];
+    UINT i, j, len, done;
     NTSTATUS status;
 
-    for (i = 0; i < count; i++)
+    for (i = 0; i < count; i += done)
     {
-        if (inputs[i].type == INPUT_MOUSE)
+        len = min( count - i, sizeof(buffer) / sizeof(buffer[0]) );
+        for (j = 0; j < len; j++)
         {
+            buffer[j] = inputs[i + j];
             /* we need to update the coordinates to what the server expects */
-            INPUT input = inputs[i];
-            update_mouse_coords( &input );
-            status = send_hardware_message( 0, &input, SEND_HWMSG_INJECTED );
+            if (buffer[j].type == INPUT_MOUSE) update_mouse_coords( &buffer[j] );
         }
-        else status = send_hardware_message( 0, &inputs[i], SEND_HWMSG_INJECTED );
 
-        if (status)
+        if ((status = send_hardware_messages( 0, buffer, len, SEND_HWMSG_INJECTED, &done )))
         {
             SetLastError( RtlNtStatusToDosError(status) );
-            break;
+            return i + done;
         }
     }
 
-    return i;
+    return count;
 }
 
 
@@ -441,7 +441,7 @@ SHORT WINAPI DECLSPEC_HOTPATCH GetAsyncKeyState( INT key )
  */
 DWORD WINAPI GetQueueStatus( UINT flags )
 {
-    DWORD ret;
+    DWORD ret, wake_bits, changed_bits;
 
     if (flags & ~(QS_ALLINPUT | QS_ALLPOSTMESSAGE | QS_SMRESULT))
     {
@@ -451,6 +451,10 @@ DWORD WINAPI GetQueueStatus( UINT flags )
 
     check_for_events( flags );
 
+    /* no need to ask the server if there are no changed bits to clear */
+    if (get_shared_queue_bits( NULL, &wake_bits, &changed_bits ) && !(changed_bits & flags))
+        return MAKELONG( 0, wake_bits & flags );
+
     SERVER_START_REQ( get_queue_status )
     {
         req->clear_bits = flags;
@@ -467,10 +471,13 @@ DWORD WINAPI GetQueueStatus( UINT flags )
  */
 BOOL WINAPI GetInputState(void)
 {
-    DWORD ret;
+    DWORD ret, wake_bits, changed_bits;
 
     check_for_events( QS_INPUT );
 
+    if (get_shared_queue_bits( NULL, &wake_bits, &changed_bits ))
+        return wake_bits & (QS_KEY | QS_MOUSEBUTTON);
+
     SERVER_START_REQ( get_queue_status )
     {
         req->clear_bits = 0;
@@ -639,11 +646,81 @@ UINT WINAPI GetRawInputData(HRAWINPUT rawinput, UINT command, void *data, UINT *
 /******************************************************************
 *		GetRawInputBuffer (USER32.@)
 */
-UINT WINAPI DECLSPEC_HOTPATCH GetRawInputBuffer(PRAWINPUT pData, PUINT pcbSize, UINT cbSizeHeader)
+UINT WINAPI DECLSPEC_HOTPATCH GetRawInputBuffer(RAWINPUT *data, UINT *data_size, UINT header_size)
 {
-    FIXME("(pData=%p, pcbSize=%p, cbSizeHeader=%d) stub!\n", pData, pcbSize, cbSizeHeader);
+    struct hardware_msg_data *msg_data = NULL;
+    RAWINPUT *rawinput = data;
+    UINT i, ret = 0, count = 0, max_count = 0, next_size = 0;
+    const UINT mouse_size = RAWINPUT_ALIGN(FIELD_OFFSET(RAWINPUT, data) + sizeof(RAWMOUSE));
+    const UINT keyboard_size = RAWINPUT_ALIGN(FIELD_OFFSET(RAWINPUT, data) + sizeof(RAWKEYBOARD));
+    NTSTATUS status;
 
-    return 0;
+    TRACE("data %p, data_size %p, header_size %u.\n", data, data_size, header_size);
+
+    if (header_size != sizeof(RAWINPUTHEADER))
+    {
+        WARN("Invalid structure size %u.\n", header_size);
+        SetLastError( ERROR_INVALID_PARAMETER );
+        return ~0U;
+    }
+    if (!data_size)
+    {
+        SetLastError( ERROR_INVALID_PARAMETER );
+        return ~0U;
+    }
+
+    /* the server packs records by their actual size, allow for the smallest ones */
+    if (data && (max_count = *data_size / min(mouse_size, keyboard_size)))
+    {
+        if (!(msg_data = HeapAlloc( GetProcessHeap(), 0, max_count * sizeof(*msg_data) )))
+        {
+            SetLastError( ERROR_NOT_ENOUGH_MEMORY );
+            return ~0U;
+        }
+    }
+
+    SERVER_START_REQ( get_rawinput_buffer )
+    {
+        req->mouse_size    = mouse_size;
+        req->keyboard_size = keyboard_size;
+        req->buffer_size   = data ? *data_size : 0;
+        if (msg_data) wine_server_set_reply( req, msg_data, max_count * sizeof(*msg_data) );
+        if (!(status = wine_server_call( req )))
+        {
+            count     = reply->count;
+            next_size = reply->next_size;
+        }
+    }
+    SERVER_END_REQ;
+
+    if (status)
+    {
+        HeapFree( GetProcessHeap(), 0, msg_data );
+        SetLastError( RtlNtStatusToDosError(status) );
+        return ~0U;
+    }
+
+    if (!data)
+    {
+        *data_size = next_size;
+        return 0;
+    }
+    if (!count && next_size)
+    {
+        *data_size = next_size;
+        SetLastError( ERROR_INSUFFICIENT_BUFFER );
+        return ~0U;
+    }
+
+    for (i = 0; i < count; i++)
+    {
+        if (!rawinput_from_hardware_message( rawinput, &msg_data[i] )) continue;
+        rawinput = NEXTRAWINPUTBLOCK(rawinput);
+        ret++;
+    }
+    HeapFree( GetProcessHeap(), 0, msg_data );
+
+    return ret;
 }
 
 
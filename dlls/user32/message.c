@@ -2280,17 +2280,13 @@ static void accept_hardware_message( UINT hw_id, BOOL remove )
 }
 
 
-static BOOL process_rawinput_message( MSG *msg, const struct hardware_msg_data *msg_data )
+/***********************************************************************
+ *          rawinput_from_hardware_message
+ *
+ * Fill a RAWINPUT structure from the server data of a WM_INPUT message.
+ */
+BOOL rawinput_from_hardware_message( RAWINPUT *rawinput, const struct hardware_msg_data *msg_data )
 {
-    struct user_thread_info *thread_info = get_user_thread_info();
-    RAWINPUT *rawinput = thread_info->rawinput;
-
-    if (!rawinput)
-    {
-        thread_info->rawinput = HeapAlloc( GetProcessHeap(), 0, sizeof(*rawinput) );
-        if (!(rawinput = thread_info->rawinput)) return FALSE;
-    }
-
     rawinput->header.dwType = msg_data->rawinput.type;
     if (msg_data->rawinput.type == RIM_TYPEMOUSE)
     {
@@ -2388,6 +2384,23 @@ static BOOL process_rawinput_message( MSG *msg, const struct hardware_msg_data *
         return FALSE;
     }
 
+    return TRUE;
+}
+
+
+static BOOL process_rawinput_message( MSG *msg, const struct hardware_msg_data *msg_data )
+{
+    struct user_thread_info *thread_info = get_user_thread_info();
+    RAWINPUT *rawinput = thread_info->rawinput;
+
+    if (!rawinput)
+    {
+        thread_info->rawinput = HeapAlloc( GetProcessHeap(), 0, sizeof(*rawinput) );
+        if (!(rawinput = thread_info->rawinput)) return FALSE;
+    }
+
+    if (!rawinput_from_hardware_message( rawinput, msg_data )) return FALSE;
+
     msg->lParam = (LPARAM)rawinput;
     return TRUE;
 }
@@ -2726,6 +2739,93 @@ static inline void call_sendmsg_callback( SENDASYNCPROC callback, HWND hwnd, UIN
 }
 
 
+/***********************************************************************
+ *           get_server_queue_handle
+ *
+ * Get a handle to the server message queue for the current thread.
+ */
+static HANDLE get_server_queue_handle(void)
+{
+    struct user_thread_info *thread_info = get_user_thread_info();
+    HANDLE ret, shm = 0;
+
+    if (!(ret = thread_info->server_queue))
+    {
+        SERVER_START_REQ( get_msg_queue )
+        {
+            wine_server_call( req );
+            ret = wine_server_ptr_handle( reply->handle );
+            shm = wine_server_ptr_handle( reply->shm );
+        }
+        SERVER_END_REQ;
+        thread_info->server_queue = ret;
+        if (!ret) ERR( "Cannot get server thread queue\n" );
+        if (shm)
+        {
+            void *ptr = NULL;
+            SIZE_T size = 0;
+
+            if (!NtMapViewOfSection( shm, GetCurrentProcess(), &ptr, 0, 0, NULL, &size,
+                                     ViewShare, 0, PAGE_READONLY ))
+            {
+                thread_info->queue_shm = ptr;
+                thread_info->peek_seq = 1;  /* never seen while no update is in progress */
+            }
+            else
+                WARN( "Cannot map shared queue state\n" );
+            NtClose( shm );
+        }
+    }
+    return ret;
+}
+
+
+/***********************************************************************
+ *           get_shared_queue_bits
+ *
+ * Retrieve the current queue bits from the state shared with the server.
+ * Return FALSE if the shared state isn't available for this thread.
+ */
+BOOL get_shared_queue_bits( DWORD *seq, DWORD *wake_bits, DWORD *changed_bits )
+{
+    const volatile queue_shm_t *shm = get_user_thread_info()->queue_shm;
+    DWORD cur_seq;
+
+    if (!shm) return FALSE;
+    do
+    {
+        while ((cur_seq = shm->seq) & 1) /* update in progress */;
+        shm_read_barrier();
+        *wake_bits = shm->wake_bits;
+        *changed_bits = shm->changed_bits;
+        shm_read_barrier();
+    } while (shm->seq != cur_seq);
+    if (seq) *seq = cur_seq;
+    return TRUE;
+}
+
+
+/***********************************************************************
+ *           is_queue_unchanged
+ *
+ * Check if a get_message call is known to fail again because the queue
+ * didn't change since the last one, so the server call can be skipped.
+ */
+static BOOL is_queue_unchanged( struct user_thread_info *thread_info, HWND hwnd,
+                                UINT first, UINT last, UINT flags, UINT changed_mask )
+{
+    DWORD seq, wake_bits, changed_bits, filter = flags >> 16;
+
+    if (hwnd || first || last != ~0U || changed_mask) return FALSE;
+    if (!get_shared_queue_bits( &seq, &wake_bits, &changed_bits )) return FALSE;
+    if (seq != thread_info->peek_seq || filter != thread_info->peek_filter) return FALSE;
+    if (!filter) filter = QS_ALLINPUT;
+    if (wake_bits & (filter | QS_SENDMESSAGE)) return FALSE;
+    /* the server considers the queue hung if we stop asking it for messages */
+    return GetTickCount() - thread_info->peek_time < 1000;
+}
+
+
 /***********************************************************************
  *           peek_message
  *
@@ -2746,10 +2846,17 @@ static BOOL peek_message( MSG *msg, HWND hwnd, UINT first, UINT last, UINT flags
     if (!first && !last) last = ~0;
     if (hwnd == HWND_BROADCAST) hwnd = HWND_TOPMOST;
 
+    if (is_queue_unchanged( thread_info, hwnd, first, last, flags, changed_mask ))
+    {
+        HeapFree( GetProcessHeap(), 0, buffer );
+        return FALSE;
+    }
+
     for (;;)
     {
         NTSTATUS res;
         size_t size = 0;
+        unsigned int shm_seq = 0;
         const message_data_t *msg_data = buffer;
 
         SERVER_START_REQ( get_message )
@@ -2776,10 +2883,15 @@ static BOOL peek_message( MSG *msg, HWND hwnd, UINT first, UINT last, UINT flags
                 hw_id            = 0;
                 thread_info->active_hooks = reply->active_hooks;
             }
-            else buffer_size = reply->total;
+            else
+            {
+                buffer_size = reply->total;
+                shm_seq = reply->shm_seq;
+            }
         }
         SERVER_END_REQ;
 
+        thread_info->peek_seq = 1;
         if (res)
         {
             HeapFree( GetProcessHeap(), 0, buffer );
@@ -2787,6 +2899,12 @@ static BOOL peek_message( MSG *msg, HWND hwnd, UINT first, UINT last, UINT flags
             {
                 thread_info->wake_mask = changed_mask & (QS_SENDMESSAGE | QS_SMRESULT);
                 thread_info->changed_mask = changed_mask;
+                if (get_server_queue_handle() && thread_info->queue_shm)
+                {
+                    thread_info->peek_filter = flags >> 16;
+                    thread_info->peek_seq    = shm_seq;
+                    thread_info->peek_time   = GetTickCount();
+                }
             }
             if (res != STATUS_BUFFER_OVERFLOW) return FALSE;
             if (!(buffer = HeapAlloc( GetProcessHeap(), 0, buffer_size ))) return FALSE;
@@ -2978,31 +3096,6 @@ static inline void process_sent_messages(void)
 }
 
 
-/***********************************************************************
- *           get_server_queue_handle
- *
- * Get a handle to the server message queue for the current thread.
- */
-static HANDLE get_server_queue_handle(void)
-{
-    struct user_thread_info *thread_info = get_user_thread_info();
-    HANDLE ret;
-
-    if (!(ret = thread_info->server_queue))
-    {
-        SERVER_START_REQ( get_msg_queue )
-        {
-            wine_server_call( req );
-            ret = wine_server_ptr_handle( reply->handle );
-        }
-        SERVER_END_REQ;
-        thread_info->server_queue = ret;
-        if (!ret) ERR( "Cannot get server thread queue\n" );
-    }
-    return ret;
-}
-
-
 /***********************************************************************
  *           wait_message_reply
  *
@@ -3293,15 +3386,51 @@ static BOOL send_message( struct send_message_info *info, DWORD_PTR *res_ptr, BO
 
 
 /***********************************************************************
- *		send_hardware_message
+ *		init_hw_input
  */
-NTSTATUS send_hardware_message( HWND hwnd, const INPUT *input, UINT flags )
+static void init_hw_input( hw_input_t *hw_input, const INPUT *input )
+{
+    hw_input->type = input->type;
+    switch (input->type)
+    {
+    case INPUT_MOUSE:
+        hw_input->mouse.x     = input->u.mi.dx;
+        hw_input->mouse.y     = input->u.mi.dy;
+        hw_input->mouse.data  = input->u.mi.mouseData;
+        hw_input->mouse.flags = input->u.mi.dwFlags;
+        hw_input->mouse.time  = input->u.mi.time;
+        hw_input->mouse.info  = input->u.mi.dwExtraInfo;
+        break;
+    case INPUT_KEYBOARD:
+        hw_input->kbd.vkey  = input->u.ki.wVk;
+        hw_input->kbd.scan  = input->u.ki.wScan;
+        hw_input->kbd.flags = input->u.ki.dwFlags;
+        hw_input->kbd.time  = input->u.ki.time;
+        hw_input->kbd.info  = input->u.ki.dwExtraInfo;
+        break;
+    case INPUT_HARDWARE:
+        hw_input->hw.msg    = input->u.hi.uMsg;
+        hw_input->hw.lparam = MAKELONG( input->u.hi.wParamL, input->u.hi.wParamH );
+        break;
+    }
+}
+
+
+/***********************************************************************
+ *		send_hardware_messages
+ *
+ * Queue a number of hardware inputs, using as few server calls as
+ * possible. The number of inputs actually queued is returned in done.
+ */
+NTSTATUS send_hardware_messages( HWND hwnd, const INPUT *inputs, UINT count, UINT flags, UINT *done )
 {
     struct user_key_state_info *key_state_info = get_user_thread_info()->key_state;
     struct send_message_info info;
+    hw_input_t more_input[64];
     int prev_x, prev_y, new_x, new_y;
-    INT counter = global_key_state_counter;
-    NTSTATUS ret;
+    INT counter;
+    NTSTATUS ret = STATUS_SUCCESS;
+    UINT i, more_count, sent;
     BOOL wait;
 
     info.type     = MSG_HARDWARE;
@@ -3310,65 +3439,65 @@ NTSTATUS send_hardware_message( HWND hwnd, const INPUT *input, UINT flags )
     info.flags    = 0;
     info.timeout  = 0;
 
-    SERVER_START_REQ( send_hardware_message )
+    *done = 0;
+    while (*done < count)
     {
-        req->win        = wine_server_user_handle( hwnd );
-        req->flags      = flags;
-        req->input.type = input->type;
-        switch (input->type)
+        counter = global_key_state_counter;
+        more_count = min( count - *done - 1, sizeof(more_input) / sizeof(more_input[0]) );
+        for (i = 0; i < more_count; i++) init_hw_input( &more_input[i], &inputs[*done + 1 + i] );
+
+        SERVER_START_REQ( send_hardware_message )
         {
-        case INPUT_MOUSE:
-            req->input.mouse.x     = input->u.mi.dx;
-            req->input.mouse.y     = input->u.mi.dy;
-            req->input.mouse.data  = input->u.mi.mouseData;
-            req->input.mouse.flags = input->u.mi.dwFlags;
-            req->input.mouse.time  = input->u.mi.time;
-            req->input.mouse.info  = input->u.mi.dwExtraInfo;
-            break;
-        case INPUT_KEYBOARD:
-            req->input.kbd.vkey  = input->u.ki.wVk;
-            req->input.kbd.scan  = input->u.ki.wScan;
-            req->input.kbd.flags = input->u.ki.dwFlags;
-            req->input.kbd.time  = input->u.ki.time;
-            req->input.kbd.info  = input->u.ki.dwExtraInfo;
-            break;
-        case INPUT_HARDWARE:
-            req->input.hw.msg    = input->u.hi.uMsg;
-            req->input.hw.lparam = MAKELONG( input->u.hi.wParamL, input->u.hi.wParamH );
-            break;
+            req->win   = wine_server_user_handle( hwnd );
+            req->flags = flags;
+            init_hw_input( &req->input, &inputs[*done] );
+            wine_server_add_data( req, more_input, more_count * sizeof(more_input[0]) );
+            if (key_state_info) wine_server_set_reply( req, key_state_info->state,
+                                                       sizeof(key_state_info->state) );
+            ret = wine_server_call( req );
+            wait = reply->wait;
+            sent = reply->count;
+            prev_x = reply->prev_x;
+            prev_y = reply->prev_y;
+            new_x  = reply->new_x;
+            new_y  = reply->new_y;
         }
-        if (key_state_info) wine_server_set_reply( req, key_state_info->state,
-                                                   sizeof(key_state_info->state) );
-        ret = wine_server_call( req );
-        wait = reply->wait;
-        prev_x = reply->prev_x;
-        prev_y = reply->prev_y;
-        new_x  = reply->new_x;
-        new_y  = reply->new_y;
-    }
-    SERVER_END_REQ;
+        SERVER_END_REQ;
 
-    if (!ret)
-    {
-        if (key_state_info)
+        *done += sent;
+        if (!ret)
         {
-            key_state_info->time    = GetTickCount();
-            key_state_info->counter = counter;
+            if (key_state_info)
+            {
+                key_state_info->time    = GetTickCount();
+                key_state_info->counter = counter;
+            }
+            if ((flags & SEND_HWMSG_INJECTED) && (prev_x != new_x || prev_y != new_y))
+                USER_Driver->pSetCursorPos( new_x, new_y );
         }
-        if ((flags & SEND_HWMSG_INJECTED) && (prev_x != new_x || prev_y != new_y))
-            USER_Driver->pSetCursorPos( new_x, new_y );
-    }
 
-    if (wait)
-    {
-        LRESULT ignored;
-        wait_message_reply( 0 );
-        retrieve_reply( &info, 0, &ignored );
+        if (wait)
+        {
+            LRESULT ignored;
+            wait_message_reply( 0 );
+            retrieve_reply( &info, 0, &ignored );
+        }
+        if (ret || !sent) break;
     }
     return ret;
 }
 
 
+/***********************************************************************
+ *		send_hardware_message
+ */
+NTSTATUS send_hardware_message( HWND hwnd, const INPUT *input, UINT flags )
+{
+    UINT done;
+    return send_hardware_messages( hwnd, input, 1, flags, &done );
+}
+
+
 /***********************************************************************
  *		MSG_SendInternalMessageTimeout
  *
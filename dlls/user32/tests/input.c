@@ -52,6 +52,7 @@
 
 #include "windef.h"
 #include "winbase.h"
+#include "wingdi.h"
 #include "winuser.h"
 #include "winnls.h"
 
@@ -79,6 +80,8 @@ static struct {
 static UINT (WINAPI *pSendInput) (UINT, INPUT*, size_t);
 static int (WINAPI *pGetMouseMovePointsEx) (UINT, LPMOUSEMOVEPOINT, LPMOUSEMOVEPOINT, int, DWORD);
 static UINT (WINAPI *pGetRawInputDeviceList) (PRAWINPUTDEVICELIST, PUINT, UINT);
+static UINT (WINAPI *pGetRawInputBuffer) (PRAWINPUT, PUINT, UINT);
+static BOOL (WINAPI *pRegisterRawInputDevices) (PRAWINPUTDEVICE, UINT, UINT);
 
 #define MAXKEYEVENTS 12
 #define MAXKEYMESSAGES MAXKEYEVENTS /* assuming a key event generates one
@@ -163,6 +166,8 @@ static void init_function_pointers(void)
     GET_PROC(SendInput)
     GET_PROC(GetMouseMovePointsEx)
     GET_PROC(GetRawInputDeviceList)
+    GET_PROC(GetRawInputBuffer)
+    GET_PROC(RegisterRawInputDevices)
 
 #undef GET_PROC
 }
@@ -1536,6 +1541,100 @@ static void test_GetRawInputDeviceList(void)
     ok(odevcount == oret, "expected %d, got %d\n", oret, odevcount);
 }
 
+static void test_GetRawInputBuffer(void)
+{
+    RAWINPUTDEVICE device;
+    RAWINPUT buffer[16], *rawinput;
+    INPUT inputs[100];
+    UINT i, ret, size, total = 0;
+    POINT pos;
+    HWND hwnd;
+    MSG msg;
+    BOOL res;
+
+    GetCursorPos(&pos);
+    hwnd = CreateWindowA("static", "test", WS_POPUP | WS_VISIBLE, 0, 0, 100, 100, 0, 0, 0, 0);
+    ok(hwnd != 0, "CreateWindow failed\n");
+    SetForegroundWindow(hwnd);
+    while (PeekMessageA(&msg, 0, 0, 0, PM_REMOVE)) DispatchMessageA(&msg);
+
+    device.usUsagePage = 1;
+    device.usUsage = 2;
+    device.dwFlags = 0;
+    device.hwndTarget = hwnd;
+    res = pRegisterRawInputDevices(&device, 1, sizeof(device));
+    ok(res, "RegisterRawInputDevices failed: %u\n", GetLastError());
+
+    SetLastError(0xdeadbeef);
+    size = sizeof(buffer);
+    ret = pGetRawInputBuffer(buffer, &size, 0);
+    ok(ret == ~0U, "expected ~0U, got %u\n", ret);
+    ok(GetLastError() == ERROR_INVALID_PARAMETER, "wrong error %u\n", GetLastError());
+
+    size = 0xdeadbeef;
+    ret = pGetRawInputBuffer(NULL, &size, sizeof(RAWINPUTHEADER));
+    ok(ret == 0, "expected 0, got %u\n", ret);
+    ok(size == 0, "expected 0, got %u\n", size);
+
+    /* flood the queue with mouse motion, all sent in a single call */
+    memset(inputs, 0, sizeof(inputs));
+    for (i = 0; i < sizeof(inputs) / sizeof(inputs[0]); i++)
+    {
+        inputs[i].type = INPUT_MOUSE;
+        U(inputs[i]).mi.dx = (i & 1) ? 1 : -1;
+        U(inputs[i]).mi.dwFlags = MOUSEEVENTF_MOVE;
+    }
+    ret = pSendInput(sizeof(inputs) / sizeof(inputs[0]), inputs, sizeof(INPUT));
+    ok(ret == sizeof(inputs) / sizeof(inputs[0]), "SendInput returned %u\n", ret);
+
+    ret = GetQueueStatus(QS_RAWINPUT);
+    ok(HIWORD(ret) & QS_RAWINPUT, "QS_RAWINPUT not set, status %08x\n", ret);
+
+    size = 0;
+    ret = pGetRawInputBuffer(NULL, &size, sizeof(RAWINPUTHEADER));
+    ok(ret == 0, "expected 0, got %u\n", ret);
+    ok(size >= sizeof(RAWINPUTHEADER) + sizeof(RAWMOUSE), "wrong size %u\n", size);
+
+    SetLastError(0xdeadbeef);
+    size = sizeof(RAWINPUTHEADER);
+    ret = pGetRawInputBuffer(buffer, &size, sizeof(RAWINPUTHEADER));
+    ok(ret == ~0U, "expected ~0U, got %u\n", ret);
+    ok(GetLastError() == ERROR_INSUFFICIENT_BUFFER, "wrong error %u\n", GetLastError());
+
+    for (;;)
+    {
+        size = sizeof(buffer);
+        ret = pGetRawInputBuffer(buffer, &size, sizeof(RAWINPUTHEADER));
+        ok(ret != ~0U, "GetRawInputBuffer failed: %u\n", GetLastError());
+        if (!ret || ret == ~0U) break;
+        ok(ret <= sizeof(buffer) / sizeof(buffer[0]), "got %u records\n", ret);
+        for (i = 0, rawinput = buffer; i < ret; i++, rawinput = NEXTRAWINPUTBLOCK(rawinput))
+        {
+            ok(rawinput->header.dwType == RIM_TYPEMOUSE, "wrong type %u\n", rawinput->header.dwType);
+            ok(rawinput->header.dwSize == sizeof(RAWINPUTHEADER) + sizeof(RAWMOUSE),
+               "wrong size %u\n", rawinput->header.dwSize);
+        }
+        total += ret;
+    }
+    ok(total == sizeof(inputs) / sizeof(inputs[0]), "got %u records\n", total);
+
+    /* draining the buffer clears the raw input queue status */
+    ret = GetQueueStatus(QS_RAWINPUT);
+    ok(!(HIWORD(ret) & QS_RAWINPUT), "QS_RAWINPUT still set, status %08x\n", ret);
+
+    res = PeekMessageA(&msg, 0, WM_INPUT, WM_INPUT, PM_REMOVE);
+    ok(!res, "got WM_INPUT message\n");
+
+    device.dwFlags = RIDEV_REMOVE;
+    device.hwndTarget = 0;
+    res = pRegisterRawInputDevices(&device, 1, sizeof(device));
+    ok(res, "RegisterRawInputDevices failed: %u\n", GetLastError());
+
+    while (PeekMessageA(&msg, 0, 0, 0, PM_REMOVE)) DispatchMessageA(&msg);
+    DestroyWindow(hwnd);
+    SetCursorPos(pos.x, pos.y);
+}
+
 static void test_key_map(void)
 {
     HKL kl = GetKeyboardLayout(0);
@@ -2532,6 +2631,77 @@ static void test_OemKeyScan(void)
     }
 }
 
+struct desktop_thread_params
+{
+    HDESK desktop;
+    HWND hwnd;
+    HANDLE semaphores[2];
+};
+
+static DWORD WINAPI desktop_window_thread(void *arg)
+{
+    struct desktop_thread_params *params = arg;
+    BOOL ret;
+
+    ret = SetThreadDesktop(params->desktop);
+    ok(ret, "SetThreadDesktop failed %u\n", GetLastError());
+    params->hwnd = CreateWindowA("static", "Title", WS_POPUP, 0, 0, 10, 10, NULL, NULL, NULL, NULL);
+    ok(params->hwnd != NULL, "CreateWindowA failed %u\n", GetLastError());
+
+    ReleaseSemaphore(params->semaphores[0], 1, NULL);
+    WaitForSingleObject(params->semaphores[1], 5000);
+
+    DestroyWindow(params->hwnd);
+    return 0;
+}
+
+static void test_input_other_desktop(void)
+{
+    BOOL (CDECL *p__wine_send_input)(HWND, const INPUT *);
+    struct desktop_thread_params params;
+    HANDLE thread;
+    TEST_INPUT input;
+    DWORD result;
+    BOOL ret;
+
+    p__wine_send_input = (void *)GetProcAddress(GetModuleHandleA("user32"), "__wine_send_input");
+    if (!p__wine_send_input)
+    {
+        win_skip("__wine_send_input is not available\n");
+        return;
+    }
+
+    params.desktop = CreateDesktopA("WineTestInputDesktop", NULL, NULL, 0, GENERIC_ALL, NULL);
+    ok(params.desktop != NULL, "CreateDesktopA failed %u\n", GetLastError());
+    params.hwnd = NULL;
+    params.semaphores[0] = CreateSemaphoreA(NULL, 0, 1, NULL);
+    params.semaphores[1] = CreateSemaphoreA(NULL, 0, 1, NULL);
+
+    thread = CreateThread(NULL, 0, desktop_window_thread, &params, 0, NULL);
+    ok(thread != NULL, "CreateThread failed %u\n", GetLastError());
+    result = WaitForSingleObject(params.semaphores[0], 5000);
+    ok(result == WAIT_OBJECT_0, "WaitForSingleObject returned %u\n", result);
+
+    /* input for a window of another desktop is refused instead of being dropped silently */
+    memset(&input, 0, sizeof(input));
+    input.type = INPUT_KEYBOARD;
+    input.u.ki.wVk = VK_SHIFT;
+    input.u.ki.dwFlags = KEYEVENTF_KEYUP;
+    SetLastError(0xdeadbeef);
+    ret = p__wine_send_input(params.hwnd, (INPUT *)&input);
+    ok(!ret, "__wine_send_input succeeded\n");
+    ok(GetLastError() == ERROR_ACCESS_DENIED, "got error %u\n", GetLastError());
+
+    ReleaseSemaphore(params.semaphores[1], 1, NULL);
+    result = WaitForSingleObject(thread, 5000);
+    ok(result == WAIT_OBJECT_0, "WaitForSingleObject returned %u\n", result);
+    CloseHandle(thread);
+
+    CloseHandle(params.semaphores[0]);
+    CloseHandle(params.semaphores[1]);
+    CloseDesktop(params.desktop);
+}
+
 START_TEST(input)
 {
     init_function_pointers();
@@ -2556,6 +2726,7 @@ START_TEST(input)
     test_attach_input();
     test_GetKeyState();
     test_OemKeyScan();
+    test_input_other_desktop();
 
     if(pGetMouseMovePointsEx)
         test_GetMouseMovePointsEx();
@@ -2566,4 +2737,9 @@ START_TEST(input)
         test_GetRawInputDeviceList();
     else
         win_skip("GetRawInputDeviceList is not available\n");
+
+    if (pSendInput && pGetRawInputBuffer && pRegisterRawInputDevices)
+        test_GetRawInputBuffer();
+    else
+        win_skip("GetRawInputBuffer is not available\n");
 }
@@ -11631,6 +11631,53 @@ static void test_PeekMessage3(void)
     flush_events();
 }
 
+static DWORD WINAPI post_message_thread(void *param)
+{
+    PostThreadMessageA(PtrToUlong(param), WM_USER, 1, 2);
+    return 0;
+}
+
+static void test_PeekMessage_empty_queue(void)
+{
+    HANDLE thread;
+    DWORD qstatus, tid;
+    BOOL ret;
+    MSG msg;
+    int i;
+
+    flush_events();
+    while (PeekMessageA(&msg, 0, 0, 0, PM_REMOVE)) /* nothing */ ;
+
+    /* repeatedly peeking an empty queue must not miss messages posted later */
+    for (i = 0; i < 100; i++)
+    {
+        ret = PeekMessageA(&msg, 0, 0, 0, PM_REMOVE);
+        ok(!ret, "%d: got message %04x\n", i, msg.message);
+    }
+    qstatus = GetQueueStatus(QS_POSTMESSAGE);
+    ok(qstatus == 0, "wrong qstatus %08x\n", qstatus);
+
+    thread = CreateThread(NULL, 0, post_message_thread, ULongToPtr(GetCurrentThreadId()), 0, &tid);
+    ok(thread != NULL, "CreateThread failed: %u\n", GetLastError());
+    WaitForSingleObject(thread, INFINITE);
+    CloseHandle(thread);
+
+    qstatus = GetQueueStatus(QS_POSTMESSAGE);
+    ok(qstatus == MAKELONG(QS_POSTMESSAGE, QS_POSTMESSAGE), "wrong qstatus %08x\n", qstatus);
+    qstatus = GetQueueStatus(QS_POSTMESSAGE);
+    ok(qstatus == MAKELONG(0, QS_POSTMESSAGE), "wrong qstatus %08x\n", qstatus);
+
+    ret = PeekMessageA(&msg, 0, 0, 0, PM_REMOVE);
+    ok(ret, "no message available\n");
+    ok(msg.message == WM_USER, "got message %04x\n", msg.message);
+    ok(msg.wParam == 1 && msg.lParam == 2, "wrong params %lx %lx\n", msg.wParam, msg.lParam);
+    ret = PeekMessageA(&msg, 0, 0, 0, PM_REMOVE);
+    ok(!ret, "got message %04x\n", msg.message);
+
+    qstatus = GetQueueStatus(QS_POSTMESSAGE);
+    ok(qstatus == 0, "wrong qstatus %08x\n", qstatus);
+}
+
 static INT_PTR CALLBACK wm_quit_dlg_proc(HWND hwnd, UINT message, WPARAM wp, LPARAM lp)
 {
     struct recvd_message msg;
@@ -16623,6 +16670,7 @@ START_TEST(msg)
     test_PeekMessage();
     test_PeekMessage2();
     test_PeekMessage3();
+    test_PeekMessage_empty_queue();
     test_WaitForInputIdle( test_argv[0] );
     test_scrollwindowex();
     test_messages();
@@ -9678,6 +9678,65 @@ static void test_winproc_limit(void)
     ok(i == 1, "winproc should be called once (%d)\n", i);
 }
 
+static void other_process_window_info(HWND hwnd, HWND child)
+{
+    DWORD tid, pid;
+    RECT rect;
+
+    ok(IsWindow(hwnd), "window %p not found\n", hwnd);
+    ok(IsWindow(child), "window %p not found\n", child);
+
+    tid = GetWindowThreadProcessId(child, &pid);
+    ok(tid != 0, "wrong thread id %04x\n", tid);
+    ok(pid != GetCurrentProcessId(), "wrong process id %04x\n", pid);
+    ok(GetWindowThreadProcessId(hwnd, NULL) == tid, "wrong thread id\n");
+
+    ok(GetParent(child) == hwnd, "wrong parent %p/%p\n", GetParent(child), hwnd);
+    ok(GetParent(hwnd) == 0, "wrong parent %p\n", GetParent(hwnd));
+    ok((GetWindowLongA(hwnd, GWL_STYLE) & (WS_POPUP | WS_VISIBLE)) == (WS_POPUP | WS_VISIBLE),
+       "wrong style %08x\n", GetWindowLongA(hwnd, GWL_STYLE));
+    ok(GetWindowLongPtrA(hwnd, GWLP_USERDATA) == 0xdead, "wrong user data %lx\n",
+       GetWindowLongPtrA(hwnd, GWLP_USERDATA));
+    ok(GetWindowLongPtrA(child, GWLP_ID) == 0x42, "wrong id %lx\n", GetWindowLongPtrA(child, GWLP_ID));
+    ok(IsWindowVisible(child), "window %p not visible\n", child);
+
+    GetWindowRect(hwnd, &rect);
+    ok(rect.left == 110 && rect.top == 120 && rect.right == 240 && rect.bottom == 260,
+       "wrong window rect %s\n", wine_dbgstr_rect(&rect));
+    GetWindowRect(child, &rect);
+    ok(rect.left == 120 && rect.top == 140 && rect.right == 150 && rect.bottom == 180,
+       "wrong window rect %s\n", wine_dbgstr_rect(&rect));
+    GetClientRect(child, &rect);
+    ok(rect.left == 0 && rect.top == 0 && rect.right == 30 && rect.bottom == 40,
+       "wrong client rect %s\n", wine_dbgstr_rect(&rect));
+}
+
+static void test_other_process_window_info(const char *argv0)
+{
+    PROCESS_INFORMATION info;
+    STARTUPINFOA startup;
+    char cmd[MAX_PATH];
+    HWND hwnd, child;
+
+    hwnd = CreateWindowExA(0, "static", "test", WS_POPUP | WS_VISIBLE, 110, 120, 130, 140, 0, 0, 0, 0);
+    ok(hwnd != 0, "CreateWindowEx failed\n");
+    child = CreateWindowExA(0, "static", "child", WS_CHILD | WS_VISIBLE, 10, 20, 30, 40,
+                            hwnd, (HMENU)0x42, 0, 0);
+    ok(child != 0, "CreateWindowEx failed\n");
+    SetWindowLongPtrA(hwnd, GWLP_USERDATA, 0xdead);
+
+    sprintf(cmd, "%s win other_process_info %p %p", argv0, hwnd, child);
+    memset(&startup, 0, sizeof(startup));
+    startup.cb = sizeof(startup);
+    ok(CreateProcessA(NULL, cmd, NULL, NULL, FALSE, 0, NULL, NULL,
+                &startup, &info), "CreateProcess failed.\n");
+    winetest_wait_child_process(info.hProcess);
+    CloseHandle(info.hProcess);
+    CloseHandle(info.hThread);
+
+    DestroyWindow(hwnd);
+}
+
 static void test_deferwindowpos(void)
 {
     HDWP hdwp, hdwp2;
@@ -9872,6 +9931,16 @@ START_TEST(win)
         return;
     }
 
+    if (argc==5 && !strcmp(argv[2], "other_process_info"))
+    {
+        HWND hwnd, child;
+
+        sscanf(argv[3], "%p", &hwnd);
+        sscanf(argv[4], "%p", &child);
+        other_process_window_info(hwnd, child);
+        return;
+    }
+
     if (!RegisterWindowClasses()) assert(0);
 
     hwndMain = CreateWindowExA(/*WS_EX_TOOLWINDOW*/ 0, "MainWindowClass", "Main window",
@@ -9978,6 +10047,7 @@ START_TEST(win)
     test_GetMessagePos();
     test_activateapp(hwndMain);
     test_winproc_handles(argv[0]);
+    test_other_process_window_info(argv[0]);
     test_deferwindowpos();
     test_LockWindowUpdate(hwndMain);
     test_desktop();
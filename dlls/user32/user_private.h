@@ -28,6 +28,7 @@
 #include "winuser.h"
 #include "winreg.h"
 #include "winternl.h"
+#include "wine/server.h"
 
 #define GET_WORD(ptr)  (*(const WORD *)(ptr))
 #define GET_DWORD(ptr) (*(const DWORD *)(ptr))
@@ -173,7 +174,9 @@ struct user_thread_info
     WORD                          recursion_count;        /* SendMessage recursion counter */
     WORD                          message_count;          /* Get/PeekMessage loop counter */
     WORD                          hook_call_depth;        /* Number of recursively called hook procs */
+    WORD                          peek_filter;            /* Filter of the last empty get_message call */
     BOOL                          hook_unicode;           /* Is current hook unicode? */
+    DWORD                         peek_time;              /* Time of the last empty get_message call */
     HHOOK                         hook;                   /* Current hook */
     struct received_message_info *receive_info;           /* Message being currently received */
     struct wm_char_mapping_data  *wmchar_data;            /* Data for WM_CHAR mappings */
@@ -181,10 +184,12 @@ struct user_thread_info
     DWORD                         GetMessagePosVal;       /* Value for GetMessagePos */
     ULONG_PTR                     GetMessageExtraInfoVal; /* Value for GetMessageExtraInfo */
     UINT                          active_hooks;           /* Bitmap of active hooks */
+    DWORD                         peek_seq;               /* Queue state sequence at the last empty call */
     struct user_key_state_info   *key_state;              /* Cache of global key state */
     HWND                          top_window;             /* Desktop window */
     HWND                          msg_window;             /* HWND_MESSAGE parent window */
     RAWINPUT                     *rawinput;
+    const volatile queue_shm_t   *queue_shm;              /* Queue state shared with the server */
 };
 
 C_ASSERT( sizeof(struct user_thread_info) <= sizeof(((TEB *)0)->Win32ClientInfo) );
@@ -211,6 +216,16 @@ static inline struct user_thread_info *get_user_thread_info(void)
     return (struct user_thread_info *)NtCurrentTeb()->Win32ClientInfo;
 }
 
+/* order the reads of the state shared with the server against its sequence counter */
+static inline void shm_read_barrier(void)
+{
+#ifdef __ATOMIC_ACQUIRE
+    __atomic_thread_fence( __ATOMIC_ACQUIRE );
+#else
+    __sync_synchronize();
+#endif
+}
+
 /* check if hwnd is a broadcast magic handle */
 static inline BOOL is_broadcast( HWND hwnd )
 {
@@ -237,7 +252,11 @@ extern RECT get_virtual_screen_rect(void) DECLSPEC_HIDDEN;
 extern LRESULT call_current_hook( HHOOK hhook, INT code, WPARAM wparam, LPARAM lparam ) DECLSPEC_HIDDEN;
 extern DWORD get_input_codepage( void ) DECLSPEC_HIDDEN;
 extern BOOL map_wparam_AtoW( UINT message, WPARAM *wparam, enum wm_char_mapping mapping ) DECLSPEC_HIDDEN;
+extern BOOL rawinput_from_hardware_message( RAWINPUT *rawinput, const struct hardware_msg_data *msg_data ) DECLSPEC_HIDDEN;
 extern NTSTATUS send_hardware_message( HWND hwnd, const INPUT *input, UINT flags ) DECLSPEC_HIDDEN;
+extern NTSTATUS send_hardware_messages( HWND hwnd, const INPUT *inputs, UINT count, UINT flags,
+                                        UINT *done ) DECLSPEC_HIDDEN;
+extern BOOL get_shared_queue_bits( DWORD *seq, DWORD *wake_bits, DWORD *changed_bits ) DECLSPEC_HIDDEN;
 extern LRESULT MSG_SendInternalMessageTimeout( DWORD dest_pid, DWORD dest_tid,
                                                UINT msg, WPARAM wparam, LPARAM lparam,
                                                UINT flags, UINT timeout, PDWORD_PTR res_ptr ) DECLSPEC_HIDDEN;
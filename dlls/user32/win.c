@@ -345,6 +345,86 @@ static HWND *list_window_children( HDESK desktop, HWND hwnd, LPCWSTR class, DWOR
 }
 
 
+/***********************************************************************
+ *           get_window_shm
+ *
+ * Map the window state shared by the server, if not done already.
+ */
+static const volatile window_shm_t *get_window_shm(void)
+{
+    static const volatile window_shm_t *window_shm;
+    static BOOL window_shm_failed;
+    HANDLE handle = 0;
+    SIZE_T size = 0;
+    void *ptr = NULL;
+
+    if (window_shm || window_shm_failed) return window_shm;
+
+    SERVER_START_REQ( get_window_shm )
+    {
+        if (!wine_server_call( req )) handle = wine_server_ptr_handle( reply->handle );
+    }
+    SERVER_END_REQ;
+
+    if (!handle || NtMapViewOfSection( handle, GetCurrentProcess(), &ptr, 0, 0, NULL,
+                                       &size, ViewShare, 0, PAGE_READONLY ))
+    {
+        WARN( "failed to map the shared window state\n" );
+        window_shm_failed = TRUE;
+        if (handle) NtClose( handle );
+        return NULL;
+    }
+    NtClose( handle );
+    if (InterlockedCompareExchangePointer( (void **)&window_shm, ptr, NULL ))
+        NtUnmapViewOfSection( GetCurrentProcess(), ptr );
+    return window_shm;
+}
+
+
+/***********************************************************************
+ *           get_shared_window_info
+ *
+ * Retrieve the state of a window of another process from the data
+ * shared by the server. Return FALSE if the data isn't available, in
+ * which case the caller has to ask the server.
+ */
+static BOOL get_shared_window_info( HWND hwnd, window_shm_t *info )
+{
+    const volatile window_shm_t *shm, *entry;
+    user_handle_t handle = wine_server_user_handle( hwnd );
+    int index = ((handle & 0xffff) - FIRST_USER_HANDLE) >> 1;
+    WORD generation = handle >> 16;
+    unsigned int seq;
+
+    if (index < 0 || index >= (LAST_USER_HANDLE - FIRST_USER_HANDLE + 1) >> 1) return FALSE;
+    if (!(shm = get_window_shm())) return FALSE;
+
+    entry = &shm[index];
+    do
+    {
+        while ((seq = entry->seq) & 1) /* update in progress */;
+        shm_read_barrier();
+        info->handle     = entry->handle;
+        info->parent     = entry->parent;
+        info->owner      = entry->owner;
+        info->tid        = entry->tid;
+        info->pid        = entry->pid;
+        info->style      = entry->style;
+        info->ex_style   = entry->ex_style;
+        info->id         = entry->id;
+        info->is_unicode = entry->is_unicode;
+        info->instance   = entry->instance;
+        info->user_data  = entry->user_data;
+        info->window     = entry->window;
+        info->client     = entry->client;
+        shm_read_barrier();
+    } while (entry->seq != seq);
+
+    if (!info->handle) return FALSE;
+    return !generation || generation == 0xffff || info->handle == handle;
+}
+
+
 /*******************************************************************
  *           list_window_parents
  *
@@ -355,6 +435,7 @@ static HWND *list_window_parents( HWND hwnd )
 {
     WND *win;
     HWND current, *list;
+    window_shm_t info;
     int i, pos = 0, size = 16, count;
 
     if (!(list = HeapAlloc( GetProcessHeap(), 0, size * sizeof(HWND) ))) return NULL;
@@ -363,15 +444,22 @@ static HWND *list_window_parents( HWND hwnd )
     for (;;)
     {
         if (!(win = WIN_GetPtr( current ))) goto empty;
-        if (win == WND_OTHER_PROCESS) break;  /* need to do it the hard way */
-        if (win == WND_DESKTOP)
+        if (win == WND_OTHER_PROCESS)
+        {
+            if (!get_shared_window_info( current, &info )) break;  /* need to do it the hard way */
+            list[pos] = current = wine_server_ptr_handle( info.parent );
+        }
+        else if (win == WND_DESKTOP)
         {
             if (!pos) goto empty;
             list[pos] = 0;
             return list;
         }
-        list[pos] = current = win->parent;
-        WIN_ReleasePtr( win );
+        else
+        {
+            list[pos] = current = win->parent;
+            WIN_ReleasePtr( win );
+        }
         if (!current) return list;
         if (++pos == size - 1)
         {
@@ -710,6 +798,10 @@ HWND WIN_GetFullHandle( HWND hwnd )
     }
     else  /* may belong to another process */
     {
+        window_shm_t info;
+
+        if (get_shared_window_info( hwnd, &info )) return wine_server_ptr_handle( info.handle );
+
         SERVER_START_REQ( get_window_info )
         {
             req->handle = wine_server_user_handle( hwnd );
@@ -808,6 +900,67 @@ ULONG WIN_SetStyle( HWND hwnd, ULONG set_bits, ULONG clear_bits )
 }
 
 
+/***********************************************************************
+ *           get_shared_window_rectangles
+ *
+ * Get the rectangles of a window of another process from the data
+ * shared by the server. Return FALSE if the server has to be asked.
+ */
+static BOOL get_shared_window_rectangles( HWND hwnd, enum coords_relative relative,
+                                          RECT *rectWindow, RECT *rectClient )
+{
+    window_shm_t info, parent;
+    RECT window_rect, client_rect, rect;
+    user_handle_t handle;
+
+    if (!get_shared_window_info( hwnd, &info )) return FALSE;
+
+    SetRect( &window_rect, info.window.left, info.window.top, info.window.right, info.window.bottom );
+    SetRect( &client_rect, info.client.left, info.client.top, info.client.right, info.client.bottom );
+
+    switch (relative)
+    {
+    case COORDS_CLIENT:
+        rect = client_rect;
+        OffsetRect( &window_rect, -rect.left, -rect.top );
+        OffsetRect( &client_rect, -rect.left, -rect.top );
+        if (info.ex_style & WS_EX_LAYOUTRTL) mirror_rect( &rect, &window_rect );
+        break;
+    case COORDS_WINDOW:
+        rect = window_rect;
+        OffsetRect( &window_rect, -rect.left, -rect.top );
+        OffsetRect( &client_rect, -rect.left, -rect.top );
+        if (info.ex_style & WS_EX_LAYOUTRTL) mirror_rect( &rect, &client_rect );
+        break;
+    case COORDS_PARENT:
+        if (!info.parent) break;
+        if (!get_shared_window_info( wine_server_ptr_handle( info.parent ), &parent )) return FALSE;
+        if (parent.ex_style & WS_EX_LAYOUTRTL)
+        {
+            SetRect( &rect, parent.client.left, parent.client.top, parent.client.right, parent.client.bottom );
+            mirror_rect( &rect, &window_rect );
+            mirror_rect( &rect, &client_rect );
+        }
+        break;
+    case COORDS_SCREEN:
+        for (handle = info.parent; handle; handle = parent.parent)
+        {
+            if (!get_shared_window_info( wine_server_ptr_handle( handle ), &parent )) return FALSE;
+            if (!parent.parent) break;  /* desktop window */
+            OffsetRect( &window_rect, parent.client.left, parent.client.top );
+            OffsetRect( &client_rect, parent.client.left, parent.client.top );
+        }
+        break;
+    default:
+        return FALSE;
+    }
+
+    if (rectWindow) *rectWindow = window_rect;
+    if (rectClient) *rectClient = client_rect;
+    return TRUE;
+}
+
+
 /***********************************************************************
  *           WIN_GetRectangles
  *
@@ -915,6 +1068,8 @@ BOOL WIN_GetRectangles( HWND hwnd, enum coords_relative relative, RECT *rectWind
     }
 
 other_process:
+    if (get_shared_window_rectangles( hwnd, relative, rectWindow, rectClient )) return TRUE;
+
     SERVER_START_REQ( get_window_rectangles )
     {
         req->handle = wine_server_user_handle( hwnd );
@@ -2195,6 +2350,10 @@ BOOL WINAPI IsWindowUnicode( HWND hwnd )
     }
     else
     {
+        window_shm_t info;
+
+        if (get_shared_window_info( hwnd, &info )) return info.is_unicode;
+
         SERVER_START_REQ( get_window_info )
         {
             req->handle = wine_server_user_handle( hwnd );
@@ -2253,11 +2412,24 @@ static LONG_PTR WIN_GetWindowLong( HWND hwnd, INT offset, UINT size, BOOL unicod
 
     if (wndPtr == WND_OTHER_PROCESS)
     {
+        window_shm_t info;
+
         if (offset == GWLP_WNDPROC)
         {
             SetLastError( ERROR_ACCESS_DENIED );
             return 0;
         }
+        if (offset < 0 && get_shared_window_info( hwnd, &info ))
+        {
+            switch(offset)
+            {
+            case GWL_STYLE:      return info.style;
+            case GWL_EXSTYLE:    return info.ex_style;
+            case GWLP_ID:        return info.id;
+            case GWLP_HINSTANCE: return (ULONG_PTR)wine_server_get_ptr( info.instance );
+            case GWLP_USERDATA:  return info.user_data;
+            }
+        }
         SERVER_START_REQ( set_window_info )
         {
             req->handle = wine_server_user_handle( hwnd );
@@ -2845,6 +3017,7 @@ INT WINAPI GetWindowTextLengthW( HWND hwnd )
 BOOL WINAPI IsWindow( HWND hwnd )
 {
     WND *ptr;
+    window_shm_t info;
     BOOL ret;
 
     if (!(ptr = WIN_GetPtr( hwnd ))) return FALSE;
@@ -2857,6 +3030,8 @@ BOOL WINAPI IsWindow( HWND hwnd )
     }
 
     /* check other processes */
+    if (get_shared_window_info( hwnd, &info )) return TRUE;
+
     SERVER_START_REQ( get_window_info )
     {
         req->handle = wine_server_user_handle( hwnd );
@@ -2873,6 +3048,7 @@ BOOL WINAPI IsWindow( HWND hwnd )
 DWORD WINAPI GetWindowThreadProcessId( HWND hwnd, LPDWORD process )
 {
     WND *ptr;
+    window_shm_t info;
     DWORD tid = 0;
 
     if (!(ptr = WIN_GetPtr( hwnd )))
@@ -2891,6 +3067,12 @@ DWORD WINAPI GetWindowThreadProcessId( HWND hwnd, LPDWORD process )
     }
 
     /* check other processes */
+    if (get_shared_window_info( hwnd, &info ))
+    {
+        if (process) *process = info.pid;
+        return info.tid;
+    }
+
     SERVER_START_REQ( get_window_info )
     {
         req->handle = wine_server_user_handle( hwnd );
@@ -2921,7 +3103,16 @@ HWND WINAPI GetParent( HWND hwnd )
     if (wndPtr == WND_DESKTOP) return 0;
     if (wndPtr == WND_OTHER_PROCESS)
     {
-        LONG style = GetWindowLongW( hwnd, GWL_STYLE );
+        window_shm_t info;
+        LONG style;
+
+        if (get_shared_window_info( hwnd, &info ))
+        {
+            if (info.style & WS_POPUP) return wine_server_ptr_handle( info.owner );
+            if (info.style & WS_CHILD) return wine_server_ptr_handle( info.parent );
+            return 0;
+        }
+        style = GetWindowLongW( hwnd, GWL_STYLE );
         if (style & (WS_POPUP | WS_CHILD))
         {
             SERVER_START_REQ( get_window_tree )
@@ -93,6 +93,44 @@ static inline float to_sRGB_component(float f)
     return 1.055f * powf(f, 1.0f/2.4f) - 0.055f;
 }
 
+static float sRGB_thresholds[256];
+static INIT_ONCE sRGB_init_once = INIT_ONCE_STATIC_INIT;
+
+static BOOL WINAPI init_sRGB_thresholds(INIT_ONCE *once, void *param, void **context)
+{
+    UINT i;
+
+    /* smallest linear value that gets converted to each sRGB byte value */
+    sRGB_thresholds[0] = 0.0f;
+    for (i = 1; i < 256; i++)
+        sRGB_thresholds[i] = from_sRGB_component((i - 0.51f) / 255.0f);
+    return TRUE;
+}
+
+static const float *get_sRGB_thresholds(void)
+{
+    InitOnceExecuteOnce(&sRGB_init_once, init_sRGB_thresholds, NULL, NULL);
+    return sRGB_thresholds;
+}
+
+/* same as floorf(to_sRGB_component(f) * 255.0f + 0.51f), without calling powf for each pixel */
+static inline BYTE to_sRGB_byte(const float *thresholds, float f)
+{
+    UINT lo = 0, hi = 255, mid;
+
+    while (lo < hi)
+    {
+        mid = (lo + hi + 1) / 2;
+        if (f >= thresholds[mid]) lo = mid;
+        else hi = mid - 1;
+    }
+
+    /* values very close to a threshold may be rounded differently by powf */
+    if ((lo && f - thresholds[lo] < 1e-6f) || (lo < 255 && thresholds[lo + 1] - f < 1e-6f))
+        return (BYTE)floorf(to_sRGB_component(f) * 255.0f + 0.51f);
+    return lo;
+}
+
 #if 0 /* FIXME: enable once needed */
 static void from_sRGB(BYTE *bgr)
 {
@@ -621,7 +659,7 @@ static HRESULT copypixels_to_32bppBGRA(struct FormatConverter *This, const WICRe
             const BYTE *srcrow;
             const BYTE *srcpixel;
             BYTE *dstrow;
-            BYTE *dstpixel;
+            DWORD *dstpixel;
 
             srcstride = 3 * prc->Width;
             srcdatasize = srcstride * prc->Height;
@@ -637,12 +675,10 @@ static HRESULT copypixels_to_32bppBGRA(struct FormatConverter *This, const WICRe
                 dstrow = pbBuffer;
                 for (y=0; y<prc->Height; y++) {
                     srcpixel=srcrow;
-                    dstpixel=dstrow;
+                    dstpixel=(DWORD*)dstrow;
                     for (x=0; x<prc->Width; x++) {
-                        *dstpixel++=*srcpixel++; /* blue */
-                        *dstpixel++=*srcpixel++; /* green */
-                        *dstpixel++=*srcpixel++; /* red */
-                        *dstpixel++=255; /* alpha */
+                        *dstpixel++=0xff000000|srcpixel[2]<<16|srcpixel[1]<<8|srcpixel[0];
+                        srcpixel+=3;
                     }
                     srcrow += srcstride;
                     dstrow += cbStride;
@@ -664,8 +700,7 @@ static HRESULT copypixels_to_32bppBGRA(struct FormatConverter *This, const WICRe
             const BYTE *srcrow;
             const BYTE *srcpixel;
             BYTE *dstrow;
-            BYTE *dstpixel;
-            BYTE tmppixel[3];
+            DWORD *dstpixel;
 
             srcstride = 3 * prc->Width;
             srcdatasize = srcstride * prc->Height;
@@ -681,16 +716,10 @@ static HRESULT copypixels_to_32bppBGRA(struct FormatConverter *This, const WICRe
                 dstrow = pbBuffer;
                 for (y=0; y<prc->Height; y++) {
                     srcpixel=srcrow;
-                    dstpixel=dstrow;
+                    dstpixel=(DWORD*)dstrow;
                     for (x=0; x<prc->Width; x++) {
-                        tmppixel[0]=*srcpixel++; /* red */
-                        tmppixel[1]=*srcpixel++; /* green */
-                        tmppixel[2]=*srcpixel++; /* blue */
-
-                        *dstpixel++=tmppixel[2]; /* blue */
-                        *dstpixel++=tmppixel[1]; /* green */
-                        *dstpixel++=tmppixel[0]; /* red */
-                        *dstpixel++=255; /* alpha */
+                        *dstpixel++=0xff000000|srcpixel[0]<<16|srcpixel[1]<<8|srcpixel[2];
+                        srcpixel+=3;
                     }
                     srcrow += srcstride;
                     dstrow += cbStride;
@@ -713,8 +742,11 @@ static HRESULT copypixels_to_32bppBGRA(struct FormatConverter *This, const WICRe
 
             /* set all alpha values to 255 */
             for (y=0; y<prc->Height; y++)
+            {
+                DWORD *pixel = (DWORD *)(pbBuffer + cbStride * y);
                 for (x=0; x<prc->Width; x++)
-                    pbBuffer[cbStride*y+4*x+3] = 0xff;
+                    pixel[x] |= 0xff000000;
+            }
         }
         return S_OK;
     case format_32bppBGRA:
@@ -733,12 +765,15 @@ static HRESULT copypixels_to_32bppBGRA(struct FormatConverter *This, const WICRe
             for (y=0; y<prc->Height; y++)
                 for (x=0; x<prc->Width; x++)
                 {
-                    BYTE alpha = pbBuffer[cbStride*y+4*x+3];
+                    BYTE *pixel = pbBuffer + cbStride * y + 4 * x;
+                    BYTE alpha = pixel[3];
                     if (alpha != 0 && alpha != 255)
                     {
-                        pbBuffer[cbStride*y+4*x] = pbBuffer[cbStride*y+4*x] * 255 / alpha;
-                        pbBuffer[cbStride*y+4*x+1] = pbBuffer[cbStride*y+4*x+1] * 255 / alpha;
-                        pbBuffer[cbStride*y+4*x+2] = pbBuffer[cbStride*y+4*x+2] * 255 / alpha;
+                        /* (c * recip) >> 16 == c * 255 / alpha for all 8-bit c */
+                        DWORD recip = (255 * 65536 + alpha - 1) / alpha;
+                        pixel[0] = (pixel[0] * recip) >> 16;
+                        pixel[1] = (pixel[1] * recip) >> 16;
+                        pixel[2] = (pixel[2] * recip) >> 16;
                     }
                 }
         }
@@ -885,6 +920,20 @@ static HRESULT copypixels_to_32bppPBGRA(struct FormatConverter *This, const WICR
         if (prc)
             return IWICBitmapSource_CopyPixels(This->source, prc, cbStride, cbBufferSize, pbBuffer);
         return S_OK;
+    case format_BlackWhite:
+    case format_2bppGray:
+    case format_4bppGray:
+    case format_8bppGray:
+    case format_16bppGray:
+    case format_16bppBGR555:
+    case format_16bppBGR565:
+    case format_24bppBGR:
+    case format_24bppRGB:
+    case format_32bppBGR:
+    case format_48bppRGB:
+    case format_32bppCMYK:
+        /* opaque formats, premultiplying doesn't change anything */
+        return copypixels_to_32bppBGRA(This, prc, cbStride, cbBufferSize, pbBuffer, source_format);
     default:
         hr = copypixels_to_32bppBGRA(This, prc, cbStride, cbBufferSize, pbBuffer, source_format);
         if (SUCCEEDED(hr) && prc)
@@ -894,12 +943,14 @@ static HRESULT copypixels_to_32bppPBGRA(struct FormatConverter *This, const WICR
             for (y=0; y<prc->Height; y++)
                 for (x=0; x<prc->Width; x++)
                 {
-                    BYTE alpha = pbBuffer[cbStride*y+4*x+3];
+                    BYTE *pixel = pbBuffer + cbStride * y + 4 * x;
+                    UINT alpha = pixel[3], t;
                     if (alpha != 255)
                     {
-                        pbBuffer[cbStride*y+4*x] = pbBuffer[cbStride*y+4*x] * alpha / 255;
-                        pbBuffer[cbStride*y+4*x+1] = pbBuffer[cbStride*y+4*x+1] * alpha / 255;
-                        pbBuffer[cbStride*y+4*x+2] = pbBuffer[cbStride*y+4*x+2] * alpha / 255;
+                        /* exact c * alpha / 255 without a division */
+                        t = pixel[0] * alpha + 1; pixel[0] = (t + (t >> 8)) >> 8;
+                        t = pixel[1] * alpha + 1; pixel[1] = (t + (t >> 8)) >> 8;
+                        t = pixel[2] * alpha + 1; pixel[2] = (t + (t >> 8)) >> 8;
                     }
                 }
         }
@@ -988,6 +1039,7 @@ static HRESULT copypixels_to_24bppBGR(struct FormatConverter *This, const WICRec
             {
                 INT x, y;
                 BYTE *src = srcdata, *dst = pbBuffer;
+                const float *thresholds = get_sRGB_thresholds();
 
                 for (y = 0; y < prc->Height; y++)
                 {
@@ -996,7 +1048,7 @@ static HRESULT copypixels_to_24bppBGR(struct FormatConverter *This, const WICRec
 
                     for (x = 0; x < prc->Width; x++)
                     {
-                        BYTE gray = (BYTE)floorf(to_sRGB_component(gray_float[x]) * 255.0f + 0.51f);
+                        BYTE gray = to_sRGB_byte(thresholds, gray_float[x]);
                         *bgr++ = gray;
                         *bgr++ = gray;
                         *bgr++ = gray;
@@ -1160,6 +1212,7 @@ static HRESULT copypixels_to_8bppGray(struct FormatConverter *This, const WICRec
     {
         INT x, y;
         BYTE *src = srcdata, *dst = pbBuffer;
+        const float *thresholds = get_sRGB_thresholds();
 
         for (y = 0; y < prc->Height; y++)
         {
@@ -1169,8 +1222,7 @@ static HRESULT copypixels_to_8bppGray(struct FormatConverter *This, const WICRec
             {
                 float gray = (bgr[2] * 0.2126f + bgr[1] * 0.7152f + bgr[0] * 0.0722f) / 255.0f;
 
-                gray = to_sRGB_component(gray) * 255.0f;
-                dst[x] = (BYTE)floorf(gray + 0.51f);
+                dst[x] = to_sRGB_byte(thresholds, gray);
                 bgr += 3;
             }
             src += srcstride;
@@ -337,6 +337,7 @@ MAKE_FUNCPTR(png_set_write_fn);
 MAKE_FUNCPTR(png_read_end);
 MAKE_FUNCPTR(png_read_image);
 MAKE_FUNCPTR(png_read_info);
+MAKE_FUNCPTR(png_read_row);
 MAKE_FUNCPTR(png_write_end);
 MAKE_FUNCPTR(png_write_info);
 MAKE_FUNCPTR(png_write_rows);
@@ -406,6 +407,7 @@ static void *load_libpng(void)
         LOAD_FUNCPTR(png_read_end);
         LOAD_FUNCPTR(png_read_image);
         LOAD_FUNCPTR(png_read_info);
+        LOAD_FUNCPTR(png_read_row);
         LOAD_FUNCPTR(png_write_end);
         LOAD_FUNCPTR(png_write_info);
         LOAD_FUNCPTR(png_write_rows);
@@ -457,6 +459,10 @@ typedef struct {
     UINT stride;
     const WICPixelFormatGUID *format;
     BYTE *image_bits;
+    UINT decoded_rows;
+    BOOL interlaced;
+    BOOL decode_failed;
+    ULARGE_INTEGER data_pos; /* stream position of the image data that hasn't been decoded yet */
     CRITICAL_SECTION lock; /* must be held when png structures are accessed or initialized is set */
     ULONG metadata_count;
     metadata_block_info* metadata_blocks;
@@ -577,9 +583,6 @@ static HRESULT WINAPI PngDecoder_Initialize(IWICBitmapDecoder *iface, IStream *p
     PngDecoder *This = impl_from_IWICBitmapDecoder(iface);
     LARGE_INTEGER seek;
     HRESULT hr=S_OK;
-    png_bytep *row_pointers=NULL;
-    UINT image_size;
-    UINT i;
     int color_type, bit_depth;
     png_bytep trans;
     int num_trans;
@@ -625,7 +628,6 @@ static HRESULT WINAPI PngDecoder_Initialize(IWICBitmapDecoder *iface, IStream *p
     if (setjmp(jmpbuf))
     {
         ppng_destroy_read_struct(&This->png_ptr, &This->info_ptr, &This->end_info);
-        HeapFree(GetProcessHeap(), 0, row_pointers);
         This->png_ptr = NULL;
         hr = E_FAIL;
         goto end;
@@ -742,35 +744,15 @@ static HRESULT WINAPI PngDecoder_Initialize(IWICBitmapDecoder *iface, IStream *p
         goto end;
     }
 
-    /* read the image data */
     This->width = ppng_get_image_width(This->png_ptr, This->info_ptr);
     This->height = ppng_get_image_height(This->png_ptr, This->info_ptr);
     This->stride = (This->width * This->bpp + 7) / 8;
-    image_size = This->stride * This->height;
-
-    This->image_bits = HeapAlloc(GetProcessHeap(), 0, image_size);
-    if (!This->image_bits)
-    {
-        hr = E_OUTOFMEMORY;
-        goto end;
-    }
-
-    row_pointers = HeapAlloc(GetProcessHeap(), 0, sizeof(png_bytep)*This->height);
-    if (!row_pointers)
-    {
-        hr = E_OUTOFMEMORY;
-        goto end;
-    }
-
-    for (i=0; i<This->height; i++)
-        row_pointers[i] = This->image_bits + i * This->stride;
+    This->interlaced = ppng_set_interlace_handling(This->png_ptr) > 1;
 
-    ppng_read_image(This->png_ptr, row_pointers);
-
-    HeapFree(GetProcessHeap(), 0, row_pointers);
-    row_pointers = NULL;
-
-    ppng_read_end(This->png_ptr, This->end_info);
+    /* the image data is decoded on demand in CopyPixels */
+    seek.QuadPart = 0;
+    hr = IStream_Seek(pIStream, seek, STREAM_SEEK_CUR, &This->data_pos);
+    if (FAILED(hr)) goto end;
 
     /* Find the metadata chunks in the file. */
     seek.QuadPart = 8;
@@ -1084,12 +1066,88 @@ end:
     return hr;
 }
 
+/* decode the image up to the given row, must be called with the lock held */
+static HRESULT decode_png_rows(PngDecoder *This, UINT rows)
+{
+    png_bytep *row_pointers = NULL;
+    LARGE_INTEGER seek;
+    jmp_buf jmpbuf;
+    HRESULT hr;
+    UINT i;
+
+    if (This->decode_failed) return E_FAIL;
+    if (This->decoded_rows >= rows) return S_OK;
+
+    if (!This->image_bits &&
+        !(This->image_bits = HeapAlloc(GetProcessHeap(), 0, This->stride * This->height)))
+        return E_OUTOFMEMORY;
+
+    /* all passes of an interlaced image are needed to produce any row */
+    if (This->interlaced)
+    {
+        row_pointers = HeapAlloc(GetProcessHeap(), 0, sizeof(png_bytep)*This->height);
+        if (!row_pointers) return E_OUTOFMEMORY;
+
+        for (i=0; i<This->height; i++)
+            row_pointers[i] = This->image_bits + i * This->stride;
+    }
+
+    /* the stream may have been used for reading metadata in the meantime */
+    seek.QuadPart = This->data_pos.QuadPart;
+    hr = IStream_Seek(This->stream, seek, STREAM_SEEK_SET, NULL);
+    if (FAILED(hr))
+    {
+        HeapFree(GetProcessHeap(), 0, row_pointers);
+        return hr;
+    }
+
+    if (setjmp(jmpbuf))
+    {
+        /* libpng can't resume after an error */
+        HeapFree(GetProcessHeap(), 0, row_pointers);
+        This->decode_failed = TRUE;
+        return E_FAIL;
+    }
+    ppng_set_error_fn(This->png_ptr, jmpbuf, user_error_fn, user_warning_fn);
+
+    if (row_pointers)
+    {
+        ppng_read_image(This->png_ptr, row_pointers);
+        This->decoded_rows = This->height;
+        HeapFree(GetProcessHeap(), 0, row_pointers);
+    }
+    else
+    {
+        for (i = This->decoded_rows; i < rows; i++)
+            ppng_read_row(This->png_ptr, This->image_bits + i * This->stride, NULL);
+        This->decoded_rows = rows;
+    }
+
+    if (This->decoded_rows == This->height)
+        ppng_read_end(This->png_ptr, This->end_info);
+
+    seek.QuadPart = 0;
+    return IStream_Seek(This->stream, seek, STREAM_SEEK_CUR, &This->data_pos);
+}
+
 static HRESULT WINAPI PngDecoder_Frame_CopyPixels(IWICBitmapFrameDecode *iface,
     const WICRect *prc, UINT cbStride, UINT cbBufferSize, BYTE *pbBuffer)
 {
     PngDecoder *This = impl_from_IWICBitmapFrameDecode(iface);
+    UINT rows = This->height;
+    HRESULT hr;
+
     TRACE("(%p,%p,%u,%u,%p)\n", iface, prc, cbStride, cbBufferSize, pbBuffer);
 
+    /* only decode the rows needed for the rectangle, invalid ones are rejected by copy_pixels */
+    if (prc && prc->Y >= 0 && prc->Height >= 0 && prc->Y + prc->Height <= This->height)
+        rows = prc->Y + prc->Height;
+
+    EnterCriticalSection(&This->lock);
+    hr = decode_png_rows(This, rows);
+    LeaveCriticalSection(&This->lock);
+    if (FAILED(hr)) return hr;
+
     return copy_pixels(This->bpp, This->image_bits,
         This->width, This->height, This->stride,
         prc, cbStride, cbBufferSize, pbBuffer);
@@ -1306,6 +1364,9 @@ HRESULT PngDecoder_CreateInstance(REFIID iid, void** ppv)
     This->stream = NULL;
     This->initialized = FALSE;
     This->image_bits = NULL;
+    This->decoded_rows = 0;
+    This->interlaced = FALSE;
+    This->decode_failed = FALSE;
     InitializeCriticalSection(&This->lock);
     This->lock.DebugInfo->Spare[0] = (DWORD_PTR)(__FILE__ ": PngDecoder.lock");
     This->metadata_count = 0;
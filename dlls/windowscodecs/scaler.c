@@ -19,6 +19,7 @@
 #include "config.h"
 
 #include <stdarg.h>
+#include <math.h>
 
 #define COBJMACROS
 
@@ -32,6 +33,13 @@
 
 WINE_DEFAULT_DEBUG_CHANNEL(wincodecs);
 
+/* contributions of the source pixels to each destination pixel along one axis */
+struct scaler_filter {
+    UINT taps;       /* number of source pixels used for each destination pixel */
+    UINT *start;     /* first source pixel for each destination pixel */
+    float *weights;  /* taps weights for each destination pixel */
+};
+
 typedef struct BitmapScaler {
     IWICBitmapScaler IWICBitmapScaler_iface;
     LONG ref;
@@ -42,6 +50,8 @@ typedef struct BitmapScaler {
     UINT bpp;
     void (*fn_get_required_source_rect)(struct BitmapScaler*,UINT,UINT,WICRect*);
     void (*fn_copy_scanline)(struct BitmapScaler*,UINT,UINT,UINT,BYTE**,UINT,UINT,BYTE*);
+    struct scaler_filter filter_x, filter_y;
+    float *row;
     CRITICAL_SECTION lock; /* must be held when initialized */
 } BitmapScaler;
 
@@ -74,6 +84,18 @@ static HRESULT WINAPI BitmapScaler_QueryInterface(IWICBitmapScaler *iface, REFII
     return S_OK;
 }
 
+static void free_scaler_filters(BitmapScaler *This)
+{
+    HeapFree(GetProcessHeap(), 0, This->filter_x.start);
+    HeapFree(GetProcessHeap(), 0, This->filter_x.weights);
+    HeapFree(GetProcessHeap(), 0, This->filter_y.start);
+    HeapFree(GetProcessHeap(), 0, This->filter_y.weights);
+    HeapFree(GetProcessHeap(), 0, This->row);
+    memset(&This->filter_x, 0, sizeof(This->filter_x));
+    memset(&This->filter_y, 0, sizeof(This->filter_y));
+    This->row = NULL;
+}
+
 static ULONG WINAPI BitmapScaler_AddRef(IWICBitmapScaler *iface)
 {
     BitmapScaler *This = impl_from_IWICBitmapScaler(iface);
@@ -96,6 +118,7 @@ static ULONG WINAPI BitmapScaler_Release(IWICBitmapScaler *iface)
         This->lock.DebugInfo->Spare[0] = 0;
         DeleteCriticalSection(&This->lock);
         if (This->source) IWICBitmapSource_Release(This->source);
+        free_scaler_filters(This);
         HeapFree(GetProcessHeap(), 0, This);
     }
 
@@ -190,6 +213,147 @@ static void NearestNeighbor_CopyScanline(BitmapScaler *This,
     }
 }
 
+/* Keys cubic convolution kernel with a = -0.5 */
+static double cubic_kernel(double t)
+{
+    t = fabs(t);
+    if (t < 1.0) return (1.5 * t - 2.5) * t * t + 1.0;
+    if (t < 2.0) return ((-0.5 * t + 2.5) * t - 4.0) * t + 2.0;
+    return 0.0;
+}
+
+static HRESULT init_scaler_filter(struct scaler_filter *filter, UINT src_size, UINT dst_size,
+    WICBitmapInterpolationMode mode)
+{
+    double scale = (double)src_size / dst_size, fscale = 1.0, radius, center, weight, sum;
+    int i, j, lo, hi, idx, start;
+    float *w;
+
+    if (!src_size || !dst_size) return E_INVALIDARG;
+
+    switch (mode)
+    {
+    case WICBitmapInterpolationModeLinear:
+        radius = 1.0;
+        break;
+    case WICBitmapInterpolationModeCubic:
+        radius = 2.0;
+        break;
+    case WICBitmapInterpolationModeHighQualityCubic:
+        /* widen the kernel when shrinking so that every source pixel contributes */
+        if (scale > 1.0) fscale = scale;
+        radius = 2.0 * fscale;
+        break;
+    default: /* Fant */
+        radius = max(scale, 1.0) / 2.0;
+        break;
+    }
+
+    filter->taps = min((UINT)ceil(2.0 * radius) + 1, src_size);
+    filter->start = HeapAlloc(GetProcessHeap(), 0, dst_size * sizeof(*filter->start));
+    filter->weights = HeapAlloc(GetProcessHeap(), HEAP_ZERO_MEMORY,
+        dst_size * filter->taps * sizeof(*filter->weights));
+    if (!filter->start || !filter->weights) return E_OUTOFMEMORY;
+
+    for (i = 0; i < dst_size; i++)
+    {
+        if (mode == WICBitmapInterpolationModeFant)
+        {
+            /* average the source pixels covered by the destination pixel */
+            lo = floor(i * scale);
+            hi = ceil((i + 1) * scale) - 1;
+        }
+        else
+        {
+            center = (i + 0.5) * scale - 0.5;
+            lo = ceil(center - radius);
+            hi = floor(center + radius);
+        }
+
+        start = min(max(lo, 0), src_size - filter->taps);
+        filter->start[i] = start;
+        w = filter->weights + i * filter->taps;
+
+        sum = 0.0;
+        for (j = lo; j <= hi; j++)
+        {
+            if (mode == WICBitmapInterpolationModeFant)
+                weight = min(j + 1, (i + 1) * scale) - max(j, i * scale);
+            else if (mode == WICBitmapInterpolationModeLinear)
+                weight = max(1.0 - fabs(j - center), 0.0);
+            else
+                weight = cubic_kernel((j - center) / fscale);
+
+            /* pixels outside of the source are replaced with the edge pixels */
+            idx = min(max(j, 0), (int)src_size - 1) - start;
+            w[idx] += weight;
+            sum += weight;
+        }
+
+        if (sum != 0.0)
+            for (j = 0; j < filter->taps; j++) w[j] /= sum;
+    }
+
+    return S_OK;
+}
+
+static void Filter_GetRequiredSourceRect(BitmapScaler *This,
+    UINT x, UINT y, WICRect *src_rect)
+{
+    src_rect->X = This->filter_x.start[x];
+    src_rect->Y = This->filter_y.start[y];
+    src_rect->Width = This->filter_x.taps;
+    src_rect->Height = This->filter_y.taps;
+}
+
+static void Filter_CopyScanline(BitmapScaler *This,
+    UINT dst_x, UINT dst_y, UINT dst_width,
+    BYTE **src_data, UINT src_data_x, UINT src_data_y, BYTE *pbBuffer)
+{
+    UINT channels = This->bpp / 8;
+    UINT taps_x = This->filter_x.taps, taps_y = This->filter_y.taps;
+    UINT first_x = This->filter_x.start[dst_x];
+    UINT count = (This->filter_x.start[dst_x + dst_width - 1] + taps_x - first_x) * channels;
+    const float *wy = This->filter_y.weights + dst_y * taps_y, *wx, *src;
+    BYTE **rows = src_data + This->filter_y.start[dst_y] - src_data_y;
+    UINT offset = (first_x - src_data_x) * channels;
+    UINT i, j, c;
+    float value;
+
+    /* filter the source rows vertically first, then filter the result horizontally */
+    for (i = 0; i < count; i++)
+    {
+        value = 0.0f;
+        for (j = 0; j < taps_y; j++) value += wy[j] * rows[j][offset + i];
+        This->row[i] = value;
+    }
+
+    for (i = 0; i < dst_width; i++)
+    {
+        wx = This->filter_x.weights + (dst_x + i) * taps_x;
+        src = This->row + (This->filter_x.start[dst_x + i] - first_x) * channels;
+        for (c = 0; c < channels; c++)
+        {
+            value = 0.5f;
+            for (j = 0; j < taps_x; j++) value += wx[j] * src[j * channels + c];
+            pbBuffer[i * channels + c] = value <= 0.0f ? 0 : value >= 255.0f ? 255 : (BYTE)value;
+        }
+    }
+}
+
+static BOOL is_filterable_format(const WICPixelFormatGUID *format)
+{
+    /* formats with 8-bit channels that can be interpolated independently */
+    return IsEqualGUID(format, &GUID_WICPixelFormat8bppGray) ||
+           IsEqualGUID(format, &GUID_WICPixelFormat24bppBGR) ||
+           IsEqualGUID(format, &GUID_WICPixelFormat24bppRGB) ||
+           IsEqualGUID(format, &GUID_WICPixelFormat32bppBGR) ||
+           IsEqualGUID(format, &GUID_WICPixelFormat32bppBGRA) ||
+           IsEqualGUID(format, &GUID_WICPixelFormat32bppPBGRA) ||
+           IsEqualGUID(format, &GUID_WICPixelFormat32bppRGBA) ||
+           IsEqualGUID(format, &GUID_WICPixelFormat32bppPRGBA);
+}
+
 static HRESULT WINAPI BitmapScaler_CopyPixels(IWICBitmapScaler *iface,
     const WICRect *prc, UINT cbStride, UINT cbBufferSize, BYTE *pbBuffer)
 {
@@ -244,6 +408,13 @@ static HRESULT WINAPI BitmapScaler_CopyPixels(IWICBitmapScaler *iface,
         goto end;
     }
 
+    /* there is no source rectangle for an empty destination */
+    if (!dest_rect.Width || !dest_rect.Height)
+    {
+        hr = S_OK;
+        goto end;
+    }
+
     /* MSDN recommends calling CopyPixels once for each scanline from top to
      * bottom, and claims codecs optimize for this. Ideally, when called in this
      * way, we should avoid requesting a scanline from the source more than
@@ -335,6 +506,42 @@ static HRESULT WINAPI BitmapScaler_Initialize(IWICBitmapScaler *iface,
     {
         switch (mode)
         {
+        case WICBitmapInterpolationModeLinear:
+        case WICBitmapInterpolationModeCubic:
+        case WICBitmapInterpolationModeFant:
+        case WICBitmapInterpolationModeHighQualityCubic:
+            if (!uiWidth || !uiHeight || !This->src_width || !This->src_height)
+            {
+                hr = E_INVALIDARG;
+                break;
+            }
+            if (is_filterable_format(&src_pixelformat))
+            {
+                IWICBitmapSource_AddRef(pISource);
+                This->source = pISource;
+            }
+            else
+            {
+                hr = WICConvertBitmapSource(&GUID_WICPixelFormat32bppBGRA,
+                    pISource, &This->source);
+                This->bpp = 32;
+            }
+            if (SUCCEEDED(hr))
+                hr = init_scaler_filter(&This->filter_x, This->src_width, uiWidth, mode);
+            if (SUCCEEDED(hr))
+                hr = init_scaler_filter(&This->filter_y, This->src_height, uiHeight, mode);
+            if (SUCCEEDED(hr) &&
+                !(This->row = HeapAlloc(GetProcessHeap(), 0, This->src_width * (This->bpp / 8) * sizeof(float))))
+                hr = E_OUTOFMEMORY;
+            if (FAILED(hr))
+            {
+                if (This->source) IWICBitmapSource_Release(This->source);
+                This->source = NULL;
+                free_scaler_filters(This);
+            }
+            This->fn_get_required_source_rect = Filter_GetRequiredSourceRect;
+            This->fn_copy_scanline = Filter_CopyScanline;
+            break;
         default:
             FIXME("unsupported mode %i\n", mode);
             /* fall-through */
@@ -390,6 +597,9 @@ HRESULT BitmapScaler_Create(IWICBitmapScaler **scaler)
     This->src_height = 0;
     This->mode = 0;
     This->bpp = 0;
+    memset(&This->filter_x, 0, sizeof(This->filter_x));
+    memset(&This->filter_y, 0, sizeof(This->filter_y));
+    This->row = NULL;
     InitializeCriticalSection(&This->lock);
     This->lock.DebugInfo->Spare[0] = (DWORD_PTR)(__FILE__ ": BitmapScaler.lock");
 
@@ -972,6 +972,100 @@ static void test_clipper(void)
     IWICBitmapClipper_Release(clipper);
 }
 
+static void test_scaler(void)
+{
+    static const BYTE data[] = { 0, 100, 200, 40 };
+    static const struct
+    {
+        WICBitmapInterpolationMode mode;
+        UINT width;
+        BYTE expected[4];
+    } tests[] =
+    {
+        { WICBitmapInterpolationModeNearestNeighbor, 2, { 0, 200 } },
+        { WICBitmapInterpolationModeFant, 2, { 50, 120 } },
+        { WICBitmapInterpolationModeFant, 1, { 85 } },
+        { WICBitmapInterpolationModeLinear, 4, { 0, 100, 200, 40 } },
+        { WICBitmapInterpolationModeCubic, 4, { 0, 100, 200, 40 } },
+        { WICBitmapInterpolationModeCubic, 2, { 44, 126 } },
+        { WICBitmapInterpolationModeHighQualityCubic, 4, { 0, 100, 200, 40 } },
+        { WICBitmapInterpolationModeHighQualityCubic, 2, { 64, 118 } },
+    };
+    IWICBitmapScaler *scaler;
+    IWICBitmap *bitmap;
+    BYTE buffer[4];
+    UINT i, j, width, height;
+    WICRect rc;
+    HRESULT hr;
+
+    hr = IWICImagingFactory_CreateBitmapFromMemory(factory, 4, 1, &GUID_WICPixelFormat8bppGray,
+        sizeof(data), sizeof(data), (BYTE *)data, &bitmap);
+    ok(hr == S_OK, "got 0x%08x\n", hr);
+
+    for (i = 0; i < sizeof(tests) / sizeof(tests[0]); i++)
+    {
+        hr = IWICImagingFactory_CreateBitmapScaler(factory, &scaler);
+        ok(hr == S_OK, "got 0x%08x\n", hr);
+
+        hr = IWICBitmapScaler_Initialize(scaler, (IWICBitmapSource *)bitmap, tests[i].width, 1, tests[i].mode);
+        ok(hr == S_OK, "%u: got 0x%08x\n", i, hr);
+
+        hr = IWICBitmapScaler_GetSize(scaler, &width, &height);
+        ok(hr == S_OK, "%u: got 0x%08x\n", i, hr);
+        ok(width == tests[i].width && height == 1, "%u: got %ux%u\n", i, width, height);
+
+        memset(buffer, 0xcc, sizeof(buffer));
+        hr = IWICBitmapScaler_CopyPixels(scaler, NULL, sizeof(buffer), sizeof(buffer), buffer);
+        ok(hr == S_OK, "%u: got 0x%08x\n", i, hr);
+        for (j = 0; j < tests[i].width; j++)
+            ok(abs(buffer[j] - tests[i].expected[j]) <= 1, "%u: %u: expected %u, got %u\n",
+               i, j, tests[i].expected[j], buffer[j]);
+
+        /* empty rectangles don't copy anything */
+        memset(buffer, 0xcc, sizeof(buffer));
+        rc.X = rc.Y = 0;
+        rc.Width = 0;
+        rc.Height = 1;
+        hr = IWICBitmapScaler_CopyPixels(scaler, &rc, sizeof(buffer), sizeof(buffer), buffer);
+        ok(hr == S_OK, "%u: got 0x%08x\n", i, hr);
+        rc.Width = tests[i].width;
+        rc.Height = 0;
+        hr = IWICBitmapScaler_CopyPixels(scaler, &rc, sizeof(buffer), sizeof(buffer), buffer);
+        ok(hr == S_OK, "%u: got 0x%08x\n", i, hr);
+        for (j = 0; j < sizeof(buffer); j++)
+            ok(buffer[j] == 0xcc, "%u: %u: got %u\n", i, j, buffer[j]);
+
+        IWICBitmapScaler_Release(scaler);
+    }
+
+    hr = IWICImagingFactory_CreateBitmapScaler(factory, &scaler);
+    ok(hr == S_OK, "got 0x%08x\n", hr);
+
+    hr = IWICBitmapScaler_Initialize(scaler, (IWICBitmapSource *)bitmap, 0, 1, WICBitmapInterpolationModeCubic);
+    ok(hr == E_INVALIDARG, "got 0x%08x\n", hr);
+
+    hr = IWICBitmapScaler_Initialize(scaler, (IWICBitmapSource *)bitmap, 2, 0, WICBitmapInterpolationModeHighQualityCubic);
+    ok(hr == E_INVALIDARG, "got 0x%08x\n", hr);
+
+    IWICBitmapScaler_Release(scaler);
+    IWICBitmap_Release(bitmap);
+
+    /* an empty source can't be filtered */
+    hr = IWICImagingFactory_CreateBitmap(factory, 0, 1, &GUID_WICPixelFormat8bppGray,
+        WICBitmapCacheOnDemand, &bitmap);
+    if (hr == S_OK)
+    {
+        hr = IWICImagingFactory_CreateBitmapScaler(factory, &scaler);
+        ok(hr == S_OK, "got 0x%08x\n", hr);
+
+        hr = IWICBitmapScaler_Initialize(scaler, (IWICBitmapSource *)bitmap, 2, 1, WICBitmapInterpolationModeCubic);
+        ok(hr == E_INVALIDARG, "got 0x%08x\n", hr);
+
+        IWICBitmapScaler_Release(scaler);
+        IWICBitmap_Release(bitmap);
+    }
+}
+
 START_TEST(bitmap)
 {
     HRESULT hr;
@@ -988,6 +1082,7 @@ START_TEST(bitmap)
     test_CreateBitmapFromHICON();
     test_CreateBitmapFromHBITMAP();
     test_clipper();
+    test_scaler();
 
     IWICImagingFactory_Release(factory);
 
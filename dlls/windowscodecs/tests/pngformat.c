@@ -580,6 +580,60 @@ static void test_png_palette(void)
     IWICBitmapDecoder_Release(decoder);
 }
 
+/* 8 bpp 2x3 pixel grayscale PNG image */
+static const char png_gray_2x3[] = {
+  0x89,'P','N','G',0x0d,0x0a,0x1a,0x0a,
+  0x00,0x00,0x00,0x0d,'I','H','D','R',0x00,0x00,0x00,0x02,0x00,0x00,0x00,0x03,0x08,0x00,0x00,0x00,0x00,0x9c,0x81,0x81,0x5d,
+  0x00,0x00,0x00,0x11,'I','D','A','T',0x78,0x9c,0x63,0x10,0x10,0x64,0x50,0x50,0x64,0x30,0x30,0x04,0x00,0x02,0xb5,0x00,0xc4,
+  0xc7,0xc5,0x70,0xe3,
+  0x00,0x00,0x00,0x00,'I','E','N','D',0xae,0x42,0x60,0x82
+};
+
+static void test_png_copy_rows(void)
+{
+    static const BYTE expected[] = { 0x10, 0x11, 0x20, 0x21, 0x30, 0x31 };
+    static const UINT order[] = { 1, 0, 2, 1 };
+    IWICBitmapDecoder *decoder;
+    IWICBitmapFrameDecode *frame;
+    BYTE buffer[6];
+    WICRect rect;
+    HRESULT hr;
+    UINT i;
+
+    decoder = create_decoder(png_gray_2x3, sizeof(png_gray_2x3));
+    ok(decoder != 0, "Failed to load PNG image data\n");
+    if (!decoder) return;
+
+    hr = IWICBitmapDecoder_GetFrame(decoder, 0, &frame);
+    ok(hr == S_OK, "GetFrame error %#x\n", hr);
+
+    /* rows may be requested in any order */
+    rect.X = 0;
+    rect.Width = 2;
+    rect.Height = 1;
+    for (i = 0; i < sizeof(order) / sizeof(order[0]); i++)
+    {
+        rect.Y = order[i];
+        memset(buffer, 0xcc, sizeof(buffer));
+        hr = IWICBitmapFrameDecode_CopyPixels(frame, &rect, 2, 2, buffer);
+        ok(hr == S_OK, "%u: CopyPixels error %#x\n", i, hr);
+        ok(!memcmp(buffer, expected + 2 * order[i], 2), "%u: got %02x %02x\n", i, buffer[0], buffer[1]);
+    }
+
+    rect.Y = 2;
+    rect.Height = 2;
+    hr = IWICBitmapFrameDecode_CopyPixels(frame, &rect, 2, sizeof(buffer), buffer);
+    ok(hr == E_INVALIDARG, "got %#x\n", hr);
+
+    memset(buffer, 0xcc, sizeof(buffer));
+    hr = IWICBitmapFrameDecode_CopyPixels(frame, NULL, 2, sizeof(buffer), buffer);
+    ok(hr == S_OK, "CopyPixels error %#x\n", hr);
+    ok(!memcmp(buffer, expected, sizeof(expected)), "pixels don't match\n");
+
+    IWICBitmapFrameDecode_Release(frame);
+    IWICBitmapDecoder_Release(decoder);
+}
+
 START_TEST(pngformat)
 {
     HRESULT hr;
@@ -592,6 +646,7 @@ START_TEST(pngformat)
 
     test_color_contexts();
     test_png_palette();
+    test_png_copy_rows();
 
     IWICImagingFactory_Release(factory);
     CoUninitialize();
@@ -32,6 +32,7 @@
 WINE_DEFAULT_DEBUG_CHANNEL(d3d);
 WINE_DECLARE_DEBUG_CHANNEL(d3d_perf);
 WINE_DECLARE_DEBUG_CHANNEL(d3d_synchronous);
+WINE_DECLARE_DEBUG_CHANNEL(fps);
 
 #define WINED3D_MAX_FBO_ENTRIES 64
 #define WINED3D_ALL_LAYERS (~0u)
@@ -3839,6 +3840,8 @@ BOOL context_apply_draw_state(struct wined3d_context *context,
             wined3d_buffer_load_sysmem(state->index_buffer, context);
     }
 
+    if (TRACE_ON(fps))
+        context->applied_state_count += context->numDirtyEntries;
     for (i = 0; i < context->numDirtyEntries; ++i)
     {
         DWORD rep = context->dirtyArray[i];
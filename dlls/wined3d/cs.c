@@ -21,6 +21,7 @@
 #include "wined3d_private.h"
 
 WINE_DEFAULT_DEBUG_CHANNEL(d3d);
+WINE_DECLARE_DEBUG_CHANNEL(fps);
 
 #define WINED3D_INITIAL_CS_SIZE 4096
 
@@ -402,6 +403,7 @@ struct wined3d_cs_update_sub_resource
     unsigned int sub_resource_idx;
     struct wined3d_box box;
     struct wined3d_sub_resource_data data;
+    BYTE copy_data[1];
 };
 
 struct wined3d_cs_add_dirty_texture_region
@@ -423,6 +425,68 @@ struct wined3d_cs_stop
     enum wined3d_cs_op opcode;
 };
 
+static void wined3d_cs_stats_add_time(LONGLONG *time, const LARGE_INTEGER *start)
+{
+    LARGE_INTEGER end;
+
+    QueryPerformanceCounter(&end);
+    *time += end.QuadPart - start->QuadPart;
+}
+
+static void wined3d_cs_stats_reset(struct wined3d_cs_stats *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+    QueryPerformanceCounter(&stats->period_start);
+}
+
+/* Returns the number of milliseconds per frame since the start of the
+ * reporting period, or 0.0 if the period isn't over yet. */
+static double wined3d_cs_stats_end_frame(struct wined3d_cs_stats *stats)
+{
+    LARGE_INTEGER now, freq;
+
+    if (!stats->period_start.QuadPart)
+    {
+        wined3d_cs_stats_reset(stats);
+        return 0.0;
+    }
+
+    ++stats->frames;
+    QueryPerformanceCounter(&now);
+    QueryPerformanceFrequency(&freq);
+    /* every 1.5 seconds */
+    if ((now.QuadPart - stats->period_start.QuadPart) * 2 <= freq.QuadPart * 3)
+        return 0.0;
+
+    return 1000.0 / freq.QuadPart / stats->frames;
+}
+
+static void wined3d_cs_report_submit_stats(struct wined3d_cs *cs)
+{
+    struct wined3d_cs_stats *stats = &cs->submit_stats;
+    double scale;
+
+    if (!(scale = wined3d_cs_stats_end_frame(stats)))
+        return;
+
+    TRACE_(fps)("%p: submitted %.1f packets/frame, waited %.3f ms/frame for the command stream.\n",
+            cs, (double)stats->packets / stats->frames, stats->time * scale);
+    wined3d_cs_stats_reset(stats);
+}
+
+static void wined3d_cs_report_exec_stats(struct wined3d_cs *cs)
+{
+    struct wined3d_cs_stats *stats = &cs->exec_stats;
+    double scale;
+
+    if (!(scale = wined3d_cs_stats_end_frame(stats)))
+        return;
+
+    TRACE_(fps)("%p: executed %.1f packets/frame in %.3f ms/frame, plus %.3f ms/frame presenting.\n",
+            cs, (double)stats->packets / stats->frames, stats->time * scale, stats->present_time * scale);
+    wined3d_cs_stats_reset(stats);
+}
+
 static void wined3d_cs_exec_nop(struct wined3d_cs *cs, const void *data)
 {
 }
@@ -475,11 +539,23 @@ void wined3d_cs_emit_present(struct wined3d_cs *cs, struct wined3d_swapchain *sw
     /* Limit input latency by limiting the number of presents that we can get
      * ahead of the worker thread. We have a constant limit here, but
      * IDXGIDevice1 allows tuning this. */
-    while (pending > 1)
+    if (pending > 1)
     {
-        wined3d_pause();
-        pending = InterlockedCompareExchange(&cs->pending_presents, 0, 0);
+        LARGE_INTEGER start;
+
+        if (TRACE_ON(fps))
+            QueryPerformanceCounter(&start);
+        while (pending > 1)
+        {
+            wined3d_pause();
+            pending = InterlockedCompareExchange(&cs->pending_presents, 0, 0);
+        }
+        if (TRACE_ON(fps))
+            wined3d_cs_stats_add_time(&cs->submit_stats.time, &start);
     }
+
+    if (TRACE_ON(fps))
+        wined3d_cs_report_submit_stats(cs);
 }
 
 static void wined3d_cs_exec_clear(struct wined3d_cs *cs, const void *data)
@@ -2145,6 +2221,33 @@ void wined3d_cs_emit_update_sub_resource(struct wined3d_cs *cs, struct wined3d_r
         unsigned int slice_pitch)
 {
     struct wined3d_cs_update_sub_resource *op;
+    unsigned int size;
+
+    /* Copy the data for small buffer updates into the command stream. The
+     * update is then ordered with respect to other commands using the buffer,
+     * so we neither have to wait for the buffer to become idle, nor for the
+     * update itself to be executed. This is common for constant buffers. */
+    if (resource->type == WINED3D_RTYPE_BUFFER
+            && (size = box->right - box->left) <= WINED3D_CS_UPDATE_SUB_RESOURCE_COPY_SIZE)
+    {
+        op = cs->ops->require_space(cs, FIELD_OFFSET(struct wined3d_cs_update_sub_resource, copy_data[size]),
+                WINED3D_CS_QUEUE_DEFAULT);
+        op->opcode = WINED3D_CS_OP_UPDATE_SUB_RESOURCE;
+        op->resource = resource;
+        op->sub_resource_idx = sub_resource_idx;
+        op->box = *box;
+        op->data.row_pitch = row_pitch;
+        op->data.slice_pitch = slice_pitch;
+        op->data.data = op->copy_data;
+        memcpy(op->copy_data, data, size);
+
+        wined3d_resource_acquire(resource);
+
+        cs->ops->submit(cs, WINED3D_CS_QUEUE_DEFAULT);
+        return;
+    }
+
+    wined3d_resource_wait_idle(resource);
 
     op = cs->ops->require_space(cs, sizeof(*op), WINED3D_CS_QUEUE_MAP);
     op->opcode = WINED3D_CS_OP_UPDATE_SUB_RESOURCE;
@@ -2158,8 +2261,7 @@ void wined3d_cs_emit_update_sub_resource(struct wined3d_cs *cs, struct wined3d_r
     wined3d_resource_acquire(resource);
 
     cs->ops->submit(cs, WINED3D_CS_QUEUE_MAP);
-    /* The data pointer may go away, so we need to wait until it is read.
-     * Copying the data may be faster if it's small. */
+    /* The data pointer may go away, so we need to wait until it is read. */
     cs->ops->finish(cs, WINED3D_CS_QUEUE_MAP);
 }
 
@@ -2311,7 +2413,31 @@ static void *wined3d_cs_st_require_space(struct wined3d_cs *cs, size_t size, enu
     return (BYTE *)cs->data + cs->start;
 }
 
-static void wined3d_cs_st_submit(struct wined3d_cs *cs, enum wined3d_cs_queue_id queue_id)
+static void wined3d_cs_execute(struct wined3d_cs *cs, enum wined3d_cs_op opcode, const void *data)
+{
+    struct wined3d_cs_stats *stats = &cs->exec_stats;
+    LARGE_INTEGER start;
+
+    if (!TRACE_ON(fps))
+    {
+        wined3d_cs_op_handlers[opcode](cs, data);
+        return;
+    }
+
+    QueryPerformanceCounter(&start);
+    wined3d_cs_op_handlers[opcode](cs, data);
+    ++stats->packets;
+    if (opcode != WINED3D_CS_OP_PRESENT)
+    {
+        wined3d_cs_stats_add_time(&stats->time, &start);
+        return;
+    }
+
+    wined3d_cs_stats_add_time(&stats->present_time, &start);
+    wined3d_cs_report_exec_stats(cs);
+}
+
+static void wined3d_cs_st_execute(struct wined3d_cs *cs)
 {
     enum wined3d_cs_op opcode;
     size_t start;
@@ -2325,7 +2451,7 @@ static void wined3d_cs_st_submit(struct wined3d_cs *cs, enum wined3d_cs_queue_id
     if (opcode >= WINED3D_CS_OP_STOP)
         ERR("Invalid opcode %#x.\n", opcode);
     else
-        wined3d_cs_op_handlers[opcode](cs, &data[start]);
+        wined3d_cs_execute(cs, opcode, &data[start]);
 
     if (cs->data == data)
         cs->start = cs->end = start;
@@ -2333,6 +2459,12 @@ static void wined3d_cs_st_submit(struct wined3d_cs *cs, enum wined3d_cs_queue_id
         HeapFree(GetProcessHeap(), 0, data);
 }
 
+static void wined3d_cs_st_submit(struct wined3d_cs *cs, enum wined3d_cs_queue_id queue_id)
+{
+    ++cs->submit_stats.packets;
+    wined3d_cs_st_execute(cs);
+}
+
 static void wined3d_cs_st_finish(struct wined3d_cs *cs, enum wined3d_cs_queue_id queue_id)
 {
 }
@@ -2365,9 +2497,13 @@ static void wined3d_cs_queue_submit(struct wined3d_cs_queue *queue, struct wined
 
 static void wined3d_cs_mt_submit(struct wined3d_cs *cs, enum wined3d_cs_queue_id queue_id)
 {
+    /* Packets emitted by the command stream thread itself are executed
+     * right away and not counted, the submit statistics belong to the
+     * application thread. */
     if (cs->thread_id == GetCurrentThreadId())
-        return wined3d_cs_st_submit(cs, queue_id);
+        return wined3d_cs_st_execute(cs);
 
+    ++cs->submit_stats.packets;
     wined3d_cs_queue_submit(&cs->queue[queue_id], cs);
 }
 
@@ -2376,6 +2512,8 @@ static void *wined3d_cs_queue_require_space(struct wined3d_cs_queue *queue, size
     size_t queue_size = ARRAY_SIZE(queue->data);
     size_t header_size, packet_size, remaining;
     struct wined3d_cs_packet *packet;
+    LARGE_INTEGER start;
+    BOOL waited = FALSE;
 
     header_size = FIELD_OFFSET(struct wined3d_cs_packet, data[0]);
     size = (size + header_size - 1) & ~(header_size - 1);
@@ -2425,7 +2563,14 @@ static void *wined3d_cs_queue_require_space(struct wined3d_cs_queue *queue, size
 
         TRACE("Waiting for free space. Head %u, tail %u, packet size %lu.\n",
                 head, tail, (unsigned long)packet_size);
+        if (!waited && TRACE_ON(fps))
+        {
+            QueryPerformanceCounter(&start);
+            waited = TRUE;
+        }
     }
+    if (waited)
+        wined3d_cs_stats_add_time(&cs->submit_stats.time, &start);
 
     packet = (struct wined3d_cs_packet *)&queue->data[queue->head];
     packet->size = size;
@@ -2442,11 +2587,20 @@ static void *wined3d_cs_mt_require_space(struct wined3d_cs *cs, size_t size, enu
 
 static void wined3d_cs_mt_finish(struct wined3d_cs *cs, enum wined3d_cs_queue_id queue_id)
 {
+    LARGE_INTEGER start;
+
     if (cs->thread_id == GetCurrentThreadId())
         return wined3d_cs_st_finish(cs, queue_id);
 
+    if (wined3d_cs_queue_is_empty(&cs->queue[queue_id]))
+        return;
+
+    if (TRACE_ON(fps))
+        QueryPerformanceCounter(&start);
     while (!wined3d_cs_queue_is_empty(&cs->queue[queue_id]))
         wined3d_pause();
+    if (TRACE_ON(fps))
+        wined3d_cs_stats_add_time(&cs->submit_stats.time, &start);
 }
 
 static const struct wined3d_cs_ops wined3d_cs_mt_ops =
@@ -2539,7 +2693,7 @@ static DWORD WINAPI wined3d_cs_run(void *ctx)
                 break;
             }
 
-            wined3d_cs_op_handlers[opcode](cs, packet->data);
+            wined3d_cs_execute(cs, opcode, packet->data);
         }
 
         tail += FIELD_OFFSET(struct wined3d_cs_packet, data[packet->size]);
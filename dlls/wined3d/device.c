@@ -35,6 +35,7 @@
 #include "wined3d_private.h"
 
 WINE_DEFAULT_DEBUG_CHANNEL(d3d);
+WINE_DECLARE_DEBUG_CHANNEL(fps);
 WINE_DECLARE_DEBUG_CHANNEL(winediag);
 
 /* Define the default light parameters as specified by MSDN. */
@@ -1291,6 +1292,13 @@ UINT CDECL wined3d_device_get_available_texture_mem(const struct wined3d_device
     return min(UINT_MAX, device->adapter->vram_bytes - device->adapter->vram_bytes_used);
 }
 
+/* Counts the state changes that don't reach the GL, reported with the frame rate. */
+static void device_state_change_filtered(struct wined3d_device *device)
+{
+    if (TRACE_ON(fps))
+        InterlockedIncrement(&device->filtered_state_count);
+}
+
 void CDECL wined3d_device_set_stream_output(struct wined3d_device *device, UINT idx,
         struct wined3d_buffer *buffer, UINT offset)
 {
@@ -1365,6 +1373,7 @@ HRESULT CDECL wined3d_device_set_stream_source(struct wined3d_device *device, UI
             && stream->offset == offset)
     {
        TRACE("Application is setting the old values over, nothing to do.\n");
+       device_state_change_filtered(device);
        return WINED3D_OK;
     }
 
@@ -1758,6 +1767,7 @@ HRESULT CDECL wined3d_device_set_clip_plane(struct wined3d_device *device,
     if (!memcmp(&device->update_state->clip_planes[plane_idx], plane, sizeof(*plane)))
     {
         TRACE("Application is setting old values over, nothing to do.\n");
+        device_state_change_filtered(device);
         return WINED3D_OK;
     }
 
@@ -1812,6 +1822,13 @@ void CDECL wined3d_device_set_material(struct wined3d_device *device, const stru
 {
     TRACE("device %p, material %p.\n", device, material);
 
+    if (!device->recording && !memcmp(&device->state.material, material, sizeof(*material)))
+    {
+        TRACE("Application is setting the old material over, nothing to do.\n");
+        device_state_change_filtered(device);
+        return;
+    }
+
     device->update_state->material = *material;
 
     if (device->recording)
@@ -1896,6 +1913,13 @@ void CDECL wined3d_device_set_viewport(struct wined3d_device *device, const stru
     TRACE("x %.8e, y %.8e, w %.8e, h %.8e, min_z %.8e, max_z %.8e.\n",
           viewport->x, viewport->y, viewport->width, viewport->height, viewport->min_z, viewport->max_z);
 
+    if (!device->recording && !memcmp(&device->state.viewport, viewport, sizeof(*viewport)))
+    {
+        TRACE("Application is setting the old viewport over, nothing to do.\n");
+        device_state_change_filtered(device);
+        return;
+    }
+
     device->update_state->viewport = *viewport;
 
     /* Handle recording of state blocks */
@@ -1992,7 +2016,10 @@ void CDECL wined3d_device_set_render_state(struct wined3d_device *device,
 
     /* Compared here and not before the assignment to allow proper stateblock recording. */
     if (value == old_value)
+    {
         TRACE("Application is setting the old value over, nothing to do.\n");
+        device_state_change_filtered(device);
+    }
     else
         wined3d_cs_emit_set_render_state(device->cs, state, value);
 
@@ -2041,6 +2068,7 @@ void CDECL wined3d_device_set_sampler_state(struct wined3d_device *device,
     if (old_value == value)
     {
         TRACE("Application is setting the old value over, nothing to do.\n");
+        device_state_change_filtered(device);
         return;
     }
 
@@ -2075,6 +2103,7 @@ void CDECL wined3d_device_set_scissor_rect(struct wined3d_device *device, const
     if (EqualRect(&device->update_state->scissor_rect, rect))
     {
         TRACE("App is setting the old scissor rectangle over, nothing to do.\n");
+        device_state_change_filtered(device);
         return;
     }
     CopyRect(&device->update_state->scissor_rect, rect);
@@ -2318,6 +2347,14 @@ HRESULT CDECL wined3d_device_set_vs_consts_b(struct wined3d_device *device,
 
     if (count > WINED3D_MAX_CONSTS_B - start_idx)
         count = WINED3D_MAX_CONSTS_B - start_idx;
+    if (!device->recording && !memcmp(&device->state.vs_consts_b[start_idx], constants,
+            count * sizeof(*constants)))
+    {
+        TRACE("Application is setting the old values over, nothing to do.\n");
+        device_state_change_filtered(device);
+        return WINED3D_OK;
+    }
+
     memcpy(&device->update_state->vs_consts_b[start_idx], constants, count * sizeof(*constants));
     if (TRACE_ON(d3d))
     {
@@ -2367,6 +2404,14 @@ HRESULT CDECL wined3d_device_set_vs_consts_i(struct wined3d_device *device,
 
     if (count > WINED3D_MAX_CONSTS_I - start_idx)
         count = WINED3D_MAX_CONSTS_I - start_idx;
+    if (!device->recording && !memcmp(&device->state.vs_consts_i[start_idx], constants,
+            count * sizeof(*constants)))
+    {
+        TRACE("Application is setting the old values over, nothing to do.\n");
+        device_state_change_filtered(device);
+        return WINED3D_OK;
+    }
+
     memcpy(&device->update_state->vs_consts_i[start_idx], constants, count * sizeof(*constants));
     if (TRACE_ON(d3d))
     {
@@ -2415,6 +2460,14 @@ HRESULT CDECL wined3d_device_set_vs_consts_f(struct wined3d_device *device,
             || count > d3d_info->limits.vs_uniform_count - start_idx)
         return WINED3DERR_INVALIDCALL;
 
+    if (!device->recording && !memcmp(&device->state.vs_consts_f[start_idx], constants,
+            count * sizeof(*constants)))
+    {
+        TRACE("Application is setting the old values over, nothing to do.\n");
+        device_state_change_filtered(device);
+        return WINED3D_OK;
+    }
+
     memcpy(&device->update_state->vs_consts_f[start_idx], constants, count * sizeof(*constants));
     if (TRACE_ON(d3d))
     {
@@ -2533,6 +2586,14 @@ HRESULT CDECL wined3d_device_set_ps_consts_b(struct wined3d_device *device,
 
     if (count > WINED3D_MAX_CONSTS_B - start_idx)
         count = WINED3D_MAX_CONSTS_B - start_idx;
+    if (!device->recording && !memcmp(&device->state.ps_consts_b[start_idx], constants,
+            count * sizeof(*constants)))
+    {
+        TRACE("Application is setting the old values over, nothing to do.\n");
+        device_state_change_filtered(device);
+        return WINED3D_OK;
+    }
+
     memcpy(&device->update_state->ps_consts_b[start_idx], constants, count * sizeof(*constants));
     if (TRACE_ON(d3d))
     {
@@ -2582,6 +2643,14 @@ HRESULT CDECL wined3d_device_set_ps_consts_i(struct wined3d_device *device,
 
     if (count > WINED3D_MAX_CONSTS_I - start_idx)
         count = WINED3D_MAX_CONSTS_I - start_idx;
+    if (!device->recording && !memcmp(&device->state.ps_consts_i[start_idx], constants,
+            count * sizeof(*constants)))
+    {
+        TRACE("Application is setting the old values over, nothing to do.\n");
+        device_state_change_filtered(device);
+        return WINED3D_OK;
+    }
+
     memcpy(&device->update_state->ps_consts_i[start_idx], constants, count * sizeof(*constants));
     if (TRACE_ON(d3d))
     {
@@ -2631,6 +2700,14 @@ HRESULT CDECL wined3d_device_set_ps_consts_f(struct wined3d_device *device,
             || count > d3d_info->limits.ps_uniform_count - start_idx)
         return WINED3DERR_INVALIDCALL;
 
+    if (!device->recording && !memcmp(&device->state.ps_consts_f[start_idx], constants,
+            count * sizeof(*constants)))
+    {
+        TRACE("Application is setting the old values over, nothing to do.\n");
+        device_state_change_filtered(device);
+        return WINED3D_OK;
+    }
+
     memcpy(&device->update_state->ps_consts_f[start_idx], constants, count * sizeof(*constants));
     if (TRACE_ON(d3d))
     {
@@ -3379,6 +3456,7 @@ void CDECL wined3d_device_set_texture_stage_state(struct wined3d_device *device,
     if (old_value == value)
     {
         TRACE("Application is setting the old value over, nothing to do.\n");
+        device_state_change_filtered(device);
         return;
     }
 
@@ -3432,6 +3510,7 @@ HRESULT CDECL wined3d_device_set_texture(struct wined3d_device *device,
     if (texture == prev)
     {
         TRACE("App is setting the same texture again, nothing to do.\n");
+        device_state_change_filtered(device);
         return WINED3D_OK;
     }
 
@@ -4216,8 +4295,6 @@ void CDECL wined3d_device_update_sub_resource(struct wined3d_device *device, str
         return;
     }
 
-    wined3d_resource_wait_idle(resource);
-
     wined3d_cs_emit_update_sub_resource(device->cs, resource, sub_resource_idx, box, data, row_pitch, depth_pitch);
 }
 
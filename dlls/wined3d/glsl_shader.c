@@ -34,6 +34,7 @@
 
 #include <limits.h>
 #include <stdio.h>
+#include <stdlib.h>
 #ifdef HAVE_FLOAT_H
 # include <float.h>
 #endif
@@ -42,6 +43,7 @@
 
 WINE_DEFAULT_DEBUG_CHANNEL(d3d_shader);
 WINE_DECLARE_DEBUG_CHANNEL(d3d);
+WINE_DECLARE_DEBUG_CHANNEL(d3d_perf);
 WINE_DECLARE_DEBUG_CHANNEL(winediag);
 
 #define WINED3D_GLSL_SAMPLE_PROJECTED   0x01
@@ -131,6 +133,10 @@ struct shader_glsl_priv
     struct wine_rb_tree ffp_fragment_shaders;
     BOOL ffp_proj_control;
     BOOL legacy_lighting;
+
+    BOOL program_cache_checked;
+    BOOL use_program_cache;
+    UINT64 driver_hash;
 };
 
 struct glsl_vs_program
@@ -585,6 +591,405 @@ void shader_glsl_validate_link(const struct wined3d_gl_info *gl_info, GLuint pro
     print_glsl_info_log(gl_info, program, TRUE);
 }
 
+/* On-disk cache of linked program binaries. Entries are keyed by a hash of
+ * the GLSL source of the attached shaders and the GL driver identification
+ * strings, so updating either wined3d or the driver simply results in cache
+ * misses. The write time of an entry is updated whenever it's loaded, and
+ * the least recently used entries are evicted when the cache is full; the
+ * entries of an old driver are never loaded and get evicted first. */
+#define WINED3D_GLSL_PROGRAM_CACHE_MAGIC    0x42505357 /* "WSPB" */
+#define WINED3D_GLSL_PROGRAM_CACHE_VERSION  1
+#define WINED3D_GLSL_PROGRAM_CACHE_MAX_SHADERS 8
+
+struct glsl_program_cache_header
+{
+    DWORD magic;
+    DWORD version;
+    UINT64 key;
+    DWORD source_size;
+    DWORD format;
+    DWORD size;
+    DWORD checksum;
+};
+
+static INIT_ONCE glsl_program_cache_init_once = INIT_ONCE_STATIC_INIT;
+static LONG glsl_program_cache_size;
+
+static UINT64 glsl_program_cache_hash(UINT64 hash, const void *data, SIZE_T size)
+{
+    const BYTE *ptr = data;
+
+    /* 64-bit FNV-1a. */
+    while (size--)
+    {
+        hash ^= *ptr++;
+        hash *= ((UINT64)0x100 << 32) | 0x1b3;
+    }
+
+    return hash;
+}
+
+static UINT64 glsl_program_cache_hash_init(void)
+{
+    return ((UINT64)0xcbf29ce4 << 32) | 0x84222325;
+}
+
+static void glsl_program_cache_get_path(char *path, UINT64 key, const char *suffix)
+{
+    snprintf(path, MAX_PATH, "%s\\%08x%08x.%s", wined3d_settings.shader_cache_path,
+            (unsigned int)(key >> 32), (unsigned int)key, suffix);
+}
+
+static BOOL CALLBACK glsl_program_cache_init(INIT_ONCE *once, void *param, void **context)
+{
+    char path[MAX_PATH];
+    WIN32_FIND_DATAA data;
+    ULONGLONG size = 0;
+    HANDLE find;
+
+    CreateDirectoryA(wined3d_settings.shader_cache_path, NULL);
+
+    snprintf(path, sizeof(path), "%s\\*.bin", wined3d_settings.shader_cache_path);
+    if ((find = FindFirstFileA(path, &data)) != INVALID_HANDLE_VALUE)
+    {
+        do
+        {
+            size += data.nFileSizeLow;
+        } while (FindNextFileA(find, &data));
+        FindClose(find);
+    }
+
+    glsl_program_cache_size = min(size, INT_MAX);
+    TRACE("Shader cache %s uses %u bytes.\n",
+            debugstr_a(wined3d_settings.shader_cache_path), glsl_program_cache_size);
+
+    return TRUE;
+}
+
+static LONG glsl_program_cache_max_size(void)
+{
+    return min(wined3d_settings.shader_cache_size, INT_MAX >> 20) << 20;
+}
+
+struct glsl_program_cache_entry
+{
+    char name[MAX_PATH];
+    ULONGLONG time;
+    DWORD size;
+};
+
+static int glsl_program_cache_entry_compare(const void *a, const void *b)
+{
+    const struct glsl_program_cache_entry *e1 = a, *e2 = b;
+
+    return e1->time < e2->time ? -1 : e1->time > e2->time;
+}
+
+/* Delete the least recently used entries until there's room for "needed"
+ * bytes, leaving some slack so that this doesn't happen on every store. */
+static BOOL glsl_program_cache_evict(LONG needed)
+{
+    LONG max_size = glsl_program_cache_max_size(), target = max_size - max_size / 4;
+    struct glsl_program_cache_entry *entries = NULL, *new_entries;
+    SIZE_T count = 0, capacity = 0, i;
+    static LONG evicting;
+    char path[MAX_PATH];
+    WIN32_FIND_DATAA data;
+    LONGLONG total = 0;
+    HANDLE find;
+
+    /* Another thread is already making room. */
+    if (InterlockedCompareExchange(&evicting, 1, 0))
+        return FALSE;
+
+    snprintf(path, sizeof(path), "%s\\*.bin", wined3d_settings.shader_cache_path);
+    if ((find = FindFirstFileA(path, &data)) != INVALID_HANDLE_VALUE)
+    {
+        do
+        {
+            if (count == capacity)
+            {
+                capacity = max(capacity * 2, 256);
+                if (entries)
+                    new_entries = HeapReAlloc(GetProcessHeap(), 0, entries, capacity * sizeof(*entries));
+                else
+                    new_entries = HeapAlloc(GetProcessHeap(), 0, capacity * sizeof(*entries));
+                if (!new_entries)
+                    break;
+                entries = new_entries;
+            }
+            lstrcpynA(entries[count].name, data.cFileName, sizeof(entries[count].name));
+            entries[count].time = ((ULONGLONG)data.ftLastWriteTime.dwHighDateTime << 32)
+                    | data.ftLastWriteTime.dwLowDateTime;
+            entries[count].size = data.nFileSizeLow;
+            total += data.nFileSizeLow;
+            ++count;
+        } while (FindNextFileA(find, &data));
+        FindClose(find);
+    }
+
+    qsort(entries, count, sizeof(*entries), glsl_program_cache_entry_compare);
+    for (i = 0; i < count && total > target - needed; ++i)
+    {
+        snprintf(path, sizeof(path), "%s\\%s", wined3d_settings.shader_cache_path, entries[i].name);
+        if (DeleteFileA(path))
+            total -= entries[i].size;
+    }
+    TRACE("Evicted %lu shader cache entries, %s bytes left.\n",
+            (unsigned long)i, wine_dbgstr_longlong(total));
+    HeapFree(GetProcessHeap(), 0, entries);
+
+    /* The scan also accounts for the entries stored by other processes. */
+    InterlockedExchange(&glsl_program_cache_size, min(total, INT_MAX));
+    InterlockedExchange(&evicting, 0);
+
+    return total <= max_size - needed;
+}
+
+/* Context activation is done by the caller. */
+static BOOL shader_glsl_use_program_cache(const struct wined3d_gl_info *gl_info, struct shader_glsl_priv *priv)
+{
+    const char *str;
+    GLint count;
+    UINT64 hash;
+
+    if (priv->program_cache_checked)
+        return priv->use_program_cache;
+    priv->program_cache_checked = TRUE;
+
+    if (!wined3d_settings.shader_cache_path || !gl_info->supported[ARB_GET_PROGRAM_BINARY])
+        return FALSE;
+
+    gl_info->gl_ops.gl.p_glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &count);
+    checkGLcall("glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS)");
+    if (!count)
+    {
+        WARN("Driver doesn't support any program binary formats, not using the shader cache.\n");
+        return FALSE;
+    }
+
+    hash = glsl_program_cache_hash_init();
+    if ((str = (const char *)gl_info->gl_ops.gl.p_glGetString(GL_VENDOR)))
+        hash = glsl_program_cache_hash(hash, str, strlen(str) + 1);
+    if ((str = (const char *)gl_info->gl_ops.gl.p_glGetString(GL_RENDERER)))
+        hash = glsl_program_cache_hash(hash, str, strlen(str) + 1);
+    if ((str = (const char *)gl_info->gl_ops.gl.p_glGetString(GL_VERSION)))
+        hash = glsl_program_cache_hash(hash, str, strlen(str) + 1);
+    priv->driver_hash = hash;
+
+    InitOnceExecuteOnce(&glsl_program_cache_init_once, glsl_program_cache_init, NULL, NULL);
+
+    return priv->use_program_cache = TRUE;
+}
+
+/* Context activation is done by the caller. */
+static BOOL shader_glsl_get_program_cache_key(const struct wined3d_gl_info *gl_info,
+        const struct shader_glsl_priv *priv, GLuint program_id, UINT64 *key, DWORD *source_size)
+{
+    UINT64 hashes[WINED3D_GLSL_PROGRAM_CACHE_MAX_SHADERS], hash;
+    GLuint shaders[WINED3D_GLSL_PROGRAM_CACHE_MAX_SHADERS];
+    GLint i, j, count, length, type;
+    char *source;
+
+    GL_EXTCALL(glGetAttachedShaders(program_id, WINED3D_GLSL_PROGRAM_CACHE_MAX_SHADERS, &count, shaders));
+    checkGLcall("glGetAttachedShaders");
+
+    *source_size = 0;
+    for (i = 0; i < count; ++i)
+    {
+        GL_EXTCALL(glGetShaderiv(shaders[i], GL_SHADER_TYPE, &type));
+        GL_EXTCALL(glGetShaderiv(shaders[i], GL_SHADER_SOURCE_LENGTH, &length));
+        if (!(source = HeapAlloc(GetProcessHeap(), 0, length + 1)))
+            return FALSE;
+        GL_EXTCALL(glGetShaderSource(shaders[i], length + 1, &length, source));
+        checkGLcall("glGetShaderSource");
+
+        hash = glsl_program_cache_hash(glsl_program_cache_hash_init(), &type, sizeof(type));
+        hash = glsl_program_cache_hash(hash, source, length);
+        *source_size += length;
+        HeapFree(GetProcessHeap(), 0, source);
+
+        /* The order of attached shaders is not defined, so sort the hashes. */
+        for (j = i; j > 0 && hashes[j - 1] > hash; --j)
+            hashes[j] = hashes[j - 1];
+        hashes[j] = hash;
+    }
+
+    *key = glsl_program_cache_hash(priv->driver_hash, hashes, count * sizeof(*hashes));
+
+    return TRUE;
+}
+
+static DWORD glsl_program_cache_checksum(const void *data, DWORD size)
+{
+    UINT64 hash = glsl_program_cache_hash(glsl_program_cache_hash_init(), data, size);
+
+    return (DWORD)(hash ^ (hash >> 32));
+}
+
+/* Context activation is done by the caller. */
+static BOOL shader_glsl_load_cached_program(const struct wined3d_gl_info *gl_info,
+        GLuint program_id, UINT64 key, DWORD source_size)
+{
+    struct glsl_program_cache_header header;
+    char path[MAX_PATH];
+    DWORD file_size, read;
+    void *data = NULL;
+    BOOL ret = FALSE;
+    HANDLE file;
+    GLint tmp;
+
+    glsl_program_cache_get_path(path, key, "bin");
+    file = CreateFileA(path, GENERIC_READ | FILE_WRITE_ATTRIBUTES, FILE_SHARE_READ,
+            NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+        return FALSE;
+
+    file_size = GetFileSize(file, NULL);
+    if (file_size < sizeof(header) || !ReadFile(file, &header, sizeof(header), &read, NULL) || read != sizeof(header)
+            || header.magic != WINED3D_GLSL_PROGRAM_CACHE_MAGIC
+            || header.version != WINED3D_GLSL_PROGRAM_CACHE_VERSION
+            || header.key != key || header.source_size != source_size
+            || header.size != file_size - sizeof(header))
+    {
+        WARN("Invalid shader cache entry %s.\n", debugstr_a(path));
+        goto done;
+    }
+
+    if (!(data = HeapAlloc(GetProcessHeap(), 0, header.size)))
+        goto done;
+    if (!ReadFile(file, data, header.size, &read, NULL) || read != header.size
+            || glsl_program_cache_checksum(data, header.size) != header.checksum)
+    {
+        WARN("Corrupt shader cache entry %s.\n", debugstr_a(path));
+        goto done;
+    }
+
+    GL_EXTCALL(glProgramBinary(program_id, header.format, data, header.size));
+    checkGLcall("glProgramBinary");
+    GL_EXTCALL(glGetProgramiv(program_id, GL_LINK_STATUS, &tmp));
+    if (!(ret = !!tmp))
+    {
+        TRACE("Driver rejected cached binary %s.\n", debugstr_a(path));
+    }
+    else
+    {
+        FILETIME now;
+
+        /* Mark the entry as recently used for eviction. */
+        GetSystemTimeAsFileTime(&now);
+        SetFileTime(file, NULL, NULL, &now);
+    }
+
+done:
+    HeapFree(GetProcessHeap(), 0, data);
+    CloseHandle(file);
+
+    /* Stale and damaged entries would fail again next time. */
+    if (!ret && DeleteFileA(path))
+        InterlockedExchangeAdd(&glsl_program_cache_size, -(LONG)file_size);
+
+    return ret;
+}
+
+/* Context activation is done by the caller. */
+static void shader_glsl_store_cached_program(const struct wined3d_gl_info *gl_info,
+        GLuint program_id, UINT64 key, DWORD source_size)
+{
+    struct glsl_program_cache_header header;
+    char path[MAX_PATH], tmp_path[MAX_PATH];
+    GLint length, status;
+    DWORD written;
+    void *data;
+    HANDLE file;
+    BOOL ret;
+
+    GL_EXTCALL(glGetProgramiv(program_id, GL_LINK_STATUS, &status));
+    GL_EXTCALL(glGetProgramiv(program_id, GL_PROGRAM_BINARY_LENGTH, &length));
+    checkGLcall("glGetProgramiv");
+    if (!status || length <= 0)
+        return;
+
+    if (InterlockedExchangeAdd(&glsl_program_cache_size, length + sizeof(header))
+            > glsl_program_cache_max_size() - (LONG)(length + sizeof(header)))
+    {
+        InterlockedExchangeAdd(&glsl_program_cache_size, -(LONG)(length + sizeof(header)));
+        if (!glsl_program_cache_evict(length + sizeof(header)))
+        {
+            WARN("Shader cache is full, not storing program %u.\n", program_id);
+            return;
+        }
+        InterlockedExchangeAdd(&glsl_program_cache_size, length + sizeof(header));
+    }
+
+    if (!(data = HeapAlloc(GetProcessHeap(), 0, length)))
+        goto fail;
+    GL_EXTCALL(glGetProgramBinary(program_id, length, &length, &header.format, data));
+    checkGLcall("glGetProgramBinary");
+
+    header.magic = WINED3D_GLSL_PROGRAM_CACHE_MAGIC;
+    header.version = WINED3D_GLSL_PROGRAM_CACHE_VERSION;
+    header.key = key;
+    header.source_size = source_size;
+    header.size = length;
+    header.checksum = glsl_program_cache_checksum(data, length);
+
+    /* Write to a temporary file first, so that other processes never see
+     * partially written entries. */
+    glsl_program_cache_get_path(path, key, "bin");
+    glsl_program_cache_get_path(tmp_path, key, "tmp");
+    file = CreateFileA(tmp_path, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        HeapFree(GetProcessHeap(), 0, data);
+        goto fail;
+    }
+    ret = WriteFile(file, &header, sizeof(header), &written, NULL) && written == sizeof(header)
+            && WriteFile(file, data, length, &written, NULL) && written == length;
+    CloseHandle(file);
+    HeapFree(GetProcessHeap(), 0, data);
+
+    if (ret && MoveFileExA(tmp_path, path, MOVEFILE_REPLACE_EXISTING))
+    {
+        TRACE("Stored program %u as %s.\n", program_id, debugstr_a(path));
+        return;
+    }
+
+    WARN("Failed to write shader cache entry %s.\n", debugstr_a(path));
+    DeleteFileA(tmp_path);
+fail:
+    InterlockedExchangeAdd(&glsl_program_cache_size, -(LONG)(length + sizeof(header)));
+}
+
+/* Context activation is done by the caller. */
+static void shader_glsl_link_program(const struct wined3d_gl_info *gl_info,
+        struct shader_glsl_priv *priv, GLuint program_id, BOOL cacheable)
+{
+    DWORD source_size;
+    UINT64 key;
+
+    if (cacheable && shader_glsl_use_program_cache(gl_info, priv)
+            && shader_glsl_get_program_cache_key(gl_info, priv, program_id, &key, &source_size))
+    {
+        if (shader_glsl_load_cached_program(gl_info, program_id, key, source_size))
+        {
+            TRACE("Loaded GLSL shader program %u from the shader cache.\n", program_id);
+            return;
+        }
+
+        TRACE("Linking GLSL shader program %u.\n", program_id);
+        GL_EXTCALL(glProgramParameteri(program_id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE));
+        GL_EXTCALL(glLinkProgram(program_id));
+        shader_glsl_validate_link(gl_info, program_id);
+        shader_glsl_store_cached_program(gl_info, program_id, key, source_size);
+        return;
+    }
+
+    TRACE("Linking GLSL shader program %u.\n", program_id);
+    GL_EXTCALL(glLinkProgram(program_id));
+    shader_glsl_validate_link(gl_info, program_id);
+}
+
 static BOOL shader_glsl_use_layout_qualifier(const struct wined3d_gl_info *gl_info)
 {
     /* Layout qualifiers were introduced in GLSL 1.40. The Nvidia Legacy GPU
@@ -9562,9 +9967,7 @@ static HRESULT shader_glsl_compile_compute_shader(struct shader_glsl_priv *priv,
 
     list_add_head(&shader->linked_programs, &entry->cs.shader_entry);
 
-    TRACE("Linking GLSL shader program %u.\n", program_id);
-    GL_EXTCALL(glLinkProgram(program_id));
-    shader_glsl_validate_link(gl_info, program_id);
+    shader_glsl_link_program(gl_info, priv, program_id, TRUE);
 
     GL_EXTCALL(glUseProgram(program_id));
     checkGLcall("glUseProgram");
@@ -9878,10 +10281,10 @@ static void set_glsl_shader_program(const struct wined3d_context *context, const
         list_add_head(ps_list, &entry->ps.shader_entry);
     }
 
-    /* Link the program */
-    TRACE("Linking GLSL shader program %u.\n", program_id);
-    GL_EXTCALL(glLinkProgram(program_id));
-    shader_glsl_validate_link(gl_info, program_id);
+    /* Link the program. Programs using transform feedback depend on the
+     * stream output declaration as well, so don't cache those. */
+    shader_glsl_link_program(gl_info, priv, program_id,
+            !gshader || !gshader->u.gs.so_desc.element_count);
 
     shader_glsl_init_vs_uniform_locations(gl_info, priv, program_id, &entry->vs,
             vshader ? vshader->limits->constant_float : 0);
@@ -10025,16 +10428,45 @@ static void set_glsl_shader_program(const struct wined3d_context *context, const
     }
 }
 
+/* Shader compilation and linking that takes longer than this during
+ * rendering is reported on the d3d_perf channel. */
+#define WINED3D_GLSL_HITCH_THRESHOLD_MS 2
+
+static void shader_glsl_report_hitch(const LARGE_INTEGER *start, GLuint program_id)
+{
+    LARGE_INTEGER end, freq;
+    ULONGLONG ms;
+
+    QueryPerformanceCounter(&end);
+    QueryPerformanceFrequency(&freq);
+    ms = (end.QuadPart - start->QuadPart) * 1000 / freq.QuadPart;
+    if (ms >= WINED3D_GLSL_HITCH_THRESHOLD_MS)
+        WARN_(d3d_perf)("Selecting GLSL program %u took %s ms.\n", program_id, wine_dbgstr_longlong(ms));
+}
+
 static void shader_glsl_precompile(void *shader_priv, struct wined3d_shader *shader)
 {
     struct wined3d_device *device = shader->device;
     struct wined3d_context *context;
 
-    if (shader->reg_maps.shader_version.type == WINED3D_SHADER_TYPE_COMPUTE)
+    switch (shader->reg_maps.shader_version.type)
     {
-        context = context_acquire(device, NULL, 0);
-        shader_glsl_compile_compute_shader(shader_priv, context, shader);
-        context_release(context);
+        case WINED3D_SHADER_TYPE_COMPUTE:
+            context = context_acquire(device, NULL, 0);
+            shader_glsl_compile_compute_shader(shader_priv, context, shader);
+            context_release(context);
+            break;
+
+        /* Hull shaders don't depend on any state, so there's only a single
+         * variant that we can compile right away, instead of on first use. */
+        case WINED3D_SHADER_TYPE_HULL:
+            context = context_acquire(device, NULL, 0);
+            find_glsl_hull_shader(context, shader_priv, shader);
+            context_release(context);
+            break;
+
+        default:
+            break;
     }
 }
 
@@ -10047,12 +10479,17 @@ static void shader_glsl_select(void *shader_priv, struct wined3d_context *contex
     struct shader_glsl_priv *priv = shader_priv;
     GLenum current_vertex_color_clamp;
     GLuint program_id, prev_id;
+    LARGE_INTEGER start;
+    BOOL perf;
 
     priv->vertex_pipe->vp_enable(gl_info, !use_vs(state));
     priv->fragment_pipe->enable_extension(gl_info, !use_ps(state));
 
     prev_id = ctx_data->glsl_program ? ctx_data->glsl_program->id : 0;
 
+    if ((perf = WARN_ON(d3d_perf)))
+        QueryPerformanceCounter(&start);
+
     set_glsl_shader_program(context, state, priv, ctx_data);
 
     if (ctx_data->glsl_program)
@@ -10066,6 +10503,9 @@ static void shader_glsl_select(void *shader_priv, struct wined3d_context *contex
         current_vertex_color_clamp = GL_FIXED_ONLY_ARB;
     }
 
+    if (perf)
+        shader_glsl_report_hitch(&start, program_id);
+
     if (ctx_data->vertex_color_clamp != current_vertex_color_clamp)
     {
         ctx_data->vertex_color_clamp = current_vertex_color_clamp;
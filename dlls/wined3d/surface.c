@@ -983,67 +983,37 @@ void surface_set_compatible_renderbuffer(struct wined3d_surface *surface, const
     checkGLcall("set_compatible_renderbuffer");
 }
 
-/* See also float_16_to_32() in wined3d_private.h */
+/* See also float_16_to_32() in wined3d_private.h. This works on the IEEE 754
+ * representation directly, rounding the mantissa to nearest, away from
+ * zero. Values too small for a 16 bit denormal become zero. */
 static inline unsigned short float_32_to_16(const float *in)
 {
-    int exp = 0;
-    float tmp = fabsf(*in);
+    const DWORD bits = *(const DWORD *)in;
     unsigned int mantissa;
     unsigned short ret;
+    int exp;
 
     /* Deal with special numbers */
-    if (*in == 0.0f)
+    if (!(bits & 0x7fffffff))
         return 0x0000;
-    if (isnan(*in))
-        return 0x7c01;
-    if (isinf(*in))
-        return (*in < 0.0f ? 0xfc00 : 0x7c00);
+    exp = (bits >> 23) & 0xff;
+    if (exp == 0xff)
+        return (bits & 0x7fffff) ? 0x7c01 : ((bits >> 16) & 0x8000) | 0x7c00;
+    if (!exp)
+        return (bits >> 16) & 0x8000;
 
-    if (tmp < (float)(1u << 10))
-    {
-        do
-        {
-            tmp = tmp * 2.0f;
-            exp--;
-        } while (tmp < (float)(1u << 10));
-    }
-    else if (tmp >= (float)(1u << 11))
-    {
-        do
-        {
-            tmp /= 2.0f;
-            exp++;
-        } while (tmp >= (float)(1u << 11));
-    }
-
-    mantissa = (unsigned int)tmp;
-    if (tmp - mantissa >= 0.5f)
-        ++mantissa; /* Round to nearest, away from zero. */
-
-    exp += 10;  /* Normalize the mantissa. */
-    exp += 15;  /* Exponent is encoded with excess 15. */
+    mantissa = 0x400 | ((bits >> 13) & 0x3ff);
+    mantissa += (bits >> 12) & 1;
+    exp += 15 - 127;
 
     if (exp > 30) /* too big */
-    {
         ret = 0x7c00; /* INF */
-    }
-    else if (exp <= 0)
-    {
-        /* exp == 0: Non-normalized mantissa. Returns 0x0000 (=0.0) for too small numbers. */
-        while (exp <= 0)
-        {
-            mantissa = mantissa >> 1;
-            ++exp;
-        }
-        ret = mantissa & 0x3ff;
-    }
+    else if (exp <= 0) /* Non-normalized mantissa. */
+        ret = (1 - exp < 32 ? mantissa >> (1 - exp) : 0) & 0x3ff;
     else
-    {
         ret = (exp << 10) | (mantissa & 0x3ff);
-    }
 
-    ret |= ((*in < 0.0f ? 1 : 0) << 15); /* Add the sign */
-    return ret;
+    return ret | ((bits >> 16) & 0x8000); /* Add the sign */
 }
 
 static void convert_r32_float_r16_float(const BYTE *src, BYTE *dst,
@@ -490,14 +490,26 @@ static void swapchain_gl_present(struct wined3d_swapchain *swapchain,
     /* FPS support */
     if (TRACE_ON(fps))
     {
+        struct wined3d_device *device = swapchain->device;
         DWORD time = GetTickCount();
+        unsigned int applied = 0, i;
+        LONG filtered;
+
         ++swapchain->frames;
 
         /* every 1.5 seconds */
         if (time - swapchain->prev_time > 1500)
         {
-            TRACE_(fps)("%p @ approx %.2ffps\n",
-                    swapchain, 1000.0 * swapchain->frames / (time - swapchain->prev_time));
+            for (i = 0; i < device->context_count; ++i)
+            {
+                applied += device->contexts[i]->applied_state_count;
+                device->contexts[i]->applied_state_count = 0;
+            }
+            filtered = InterlockedExchange(&device->filtered_state_count, 0);
+
+            TRACE_(fps)("%p @ approx %.2ffps, %.1f states applied and %.1f redundant changes filtered per frame\n",
+                    swapchain, 1000.0 * swapchain->frames / (time - swapchain->prev_time),
+                    (double)applied / swapchain->frames, (double)filtered / swapchain->frames);
             swapchain->prev_time = time;
             swapchain->frames = 0;
         }
@@ -865,6 +865,7 @@ static void convert_p8_uint_b8g8r8a8_unorm(const BYTE *src, unsigned int src_pit
     const BYTE *src_row;
     unsigned int x, y;
     DWORD *dst_row;
+    DWORD colors[256];
 
     if (!palette)
     {
@@ -879,18 +880,22 @@ static void convert_p8_uint_b8g8r8a8_unorm(const BYTE *src, unsigned int src_pit
         return;
     }
 
+    /* Build the destination colors once, so that the inner loop is a plain
+     * table lookup. */
+    for (x = 0; x < 256; ++x)
+    {
+        colors[x] = 0xff000000
+                | (palette->colors[x].rgbRed << 16)
+                | (palette->colors[x].rgbGreen << 8)
+                | palette->colors[x].rgbBlue;
+    }
+
     for (y = 0; y < height; ++y)
     {
         src_row = &src[src_pitch * y];
         dst_row = (DWORD *)&dst[dst_pitch * y];
         for (x = 0; x < width; ++x)
-        {
-            BYTE src_color = src_row[x];
-            dst_row[x] = 0xff000000
-                    | (palette->colors[src_color].rgbRed << 16)
-                    | (palette->colors[src_color].rgbGreen << 8)
-                    | palette->colors[src_color].rgbBlue;
-        }
+            dst_row[x] = colors[src_row[x]];
     }
 }
 
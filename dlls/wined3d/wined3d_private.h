@@ -398,6 +398,8 @@ struct wined3d_settings
     unsigned int max_sm_ps;
     unsigned int max_sm_cs;
     BOOL no_3d;
+    char *shader_cache_path;
+    unsigned int shader_cache_size;
 };
 
 extern struct wined3d_settings wined3d_settings DECLSPEC_HIDDEN;
@@ -1784,6 +1786,7 @@ struct wined3d_context
      */
     DWORD                   dirtyArray[STATE_HIGHEST + 1]; /* Won't get bigger than that, a state is never marked dirty 2 times */
     DWORD                   numDirtyEntries;
+    unsigned int applied_state_count; /* Dirty states applied since the last frame, for the fps channel */
     DWORD isStateDirty[STATE_HIGHEST / (sizeof(DWORD) * CHAR_BIT) + 1]; /* Bitmap to find out quickly if a state is dirty */
     unsigned int dirty_compute_states[STATE_COMPUTE_COUNT / (sizeof(unsigned int) * CHAR_BIT) + 1];
 
@@ -2859,6 +2862,9 @@ struct wined3d_device
     /* Context management */
     struct wined3d_context **contexts;
     UINT context_count;
+
+    /* Redundant state changes filtered since the last frame, for the fps channel */
+    LONG filtered_state_count;
 };
 
 void device_clear_render_targets(struct wined3d_device *device, UINT rt_count, const struct wined3d_fb_state *fb,
@@ -3365,6 +3371,7 @@ enum wined3d_push_constants
 #define WINED3D_CS_QUERY_POLL_INTERVAL  10u
 #define WINED3D_CS_QUEUE_SIZE           0x100000u
 #define WINED3D_CS_SPIN_COUNT           10000000u
+#define WINED3D_CS_UPDATE_SUB_RESOURCE_COPY_SIZE 0x4000u
 
 struct wined3d_cs_queue
 {
@@ -3381,6 +3388,15 @@ struct wined3d_cs_ops
             unsigned int start_idx, unsigned int count, const void *constants);
 };
 
+struct wined3d_cs_stats
+{
+    LARGE_INTEGER period_start;
+    LONGLONG time;
+    LONGLONG present_time;
+    unsigned int packets;
+    unsigned int frames;
+};
+
 struct wined3d_cs
 {
     const struct wined3d_cs_ops *ops;
@@ -3399,6 +3415,13 @@ struct wined3d_cs
     HANDLE event;
     BOOL waiting_for_event;
     LONG pending_presents;
+
+    /* Gathered when the "fps" debug channel is enabled. The submit statistics
+     * are only updated on the application side of the command stream, i.e.
+     * never from the command stream thread, the execute statistics only by the
+     * thread executing the command stream. Neither is synchronised. */
+    struct wined3d_cs_stats submit_stats;
+    struct wined3d_cs_stats exec_stats;
 };
 
 struct wined3d_cs *wined3d_cs_create(struct wined3d_device *device) DECLSPEC_HIDDEN;
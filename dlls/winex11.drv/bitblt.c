@@ -1556,13 +1556,20 @@ DWORD get_pixmap_image( Pixmap pixmap, int width, int height, const XVisualInfo
 }
 
 
+#define MAX_DAMAGE_RECTS 8
+#define FLUSH_PERIOD     50  /* time in ms since the first damage for forcing a flush */
+
 struct x11drv_window_surface
 {
     struct window_surface header;
     Window                window;
     GC                    gc;
     XImage               *image;
-    RECT                  bounds;
+    RECT                  bounds;  /* bounds of the current drawing operation */
+    RECT                  damage[MAX_DAMAGE_RECTS];
+    int                   damage_count;
+    DWORD                 damage_ticks;
+    int                   lock_count;
     BOOL                  byteswap;
     BOOL                  is_argb;
     COLORREF              color_key;
@@ -1609,6 +1616,48 @@ static inline void add_row( HRGN rgn, RGNDATA *data, int x, int y, int len )
         flush_rgn_data( rgn, data );
 }
 
+static inline LONGLONG get_rect_area( const RECT *rect )
+{
+    return (LONGLONG)(rect->right - rect->left) * (rect->bottom - rect->top);
+}
+
+/***********************************************************************
+ *           add_damage_rect
+ *
+ * Add a rectangle to the list of areas that need to be flushed. It is merged
+ * into an existing entry if that doesn't make the total area larger, or into
+ * the entry that grows the least if the list is full.
+ */
+static void add_damage_rect( struct x11drv_window_surface *surface, const RECT *rect )
+{
+    LONGLONG cost, best_cost = 0;
+    int i, best = -1;
+    RECT tmp;
+
+    if (!surface->damage_count) surface->damage_ticks = GetTickCount();
+
+    for (i = 0; i < surface->damage_count; i++)
+    {
+        UnionRect( &tmp, &surface->damage[i], rect );
+        cost = get_rect_area( &tmp ) - get_rect_area( &surface->damage[i] ) - get_rect_area( rect );
+        if (cost <= 0)
+        {
+            surface->damage[i] = tmp;
+            return;
+        }
+        if (best == -1 || cost < best_cost)
+        {
+            best = i;
+            best_cost = cost;
+        }
+    }
+
+    if (surface->damage_count < MAX_DAMAGE_RECTS)
+        surface->damage[surface->damage_count++] = *rect;
+    else
+        UnionRect( &surface->damage[best], &surface->damage[best], rect );
+}
+
 /***********************************************************************
  *           update_surface_region
  */
@@ -1818,6 +1867,7 @@ static void x11drv_surface_lock( struct window_surface *window_surface )
     struct x11drv_window_surface *surface = get_x11_surface( window_surface );
 
     EnterCriticalSection( &surface->crit );
+    surface->lock_count++;
 }
 
 /***********************************************************************
@@ -1826,8 +1876,22 @@ static void x11drv_surface_lock( struct window_surface *window_surface )
 static void x11drv_surface_unlock( struct window_surface *window_surface )
 {
     struct x11drv_window_surface *surface = get_x11_surface( window_surface );
+    BOOL flush = FALSE;
 
+    /* the bounds are only used to collect the area touched while the surface is locked,
+     * the actual damage is kept separately so that distant updates don't get merged */
+    if (!--surface->lock_count)
+    {
+        if (!IsRectEmpty( &surface->bounds ))
+        {
+            add_damage_rect( surface, &surface->bounds );
+            reset_bounds( &surface->bounds );
+        }
+        flush = surface->damage_count && GetTickCount() - surface->damage_ticks > FLUSH_PERIOD;
+    }
     LeaveCriticalSection( &surface->crit );
+
+    if (flush) window_surface->funcs->flush( window_surface );
 }
 
 /***********************************************************************
@@ -1882,64 +1946,74 @@ static void x11drv_surface_set_region( struct window_surface *window_surface, HR
     window_surface->funcs->unlock( window_surface );
 }
 
+/***********************************************************************
+ *           put_surface_rect
+ */
+static void put_surface_rect( struct x11drv_window_surface *surface, const RECT *rect )
+{
+    unsigned char *src = surface->bits;
+    unsigned char *dst = (unsigned char *)surface->image->data;
+
+    if (src != dst)
+    {
+        const int *mapping = NULL;
+        int width_bytes = surface->image->bytes_per_line;
+
+        if (surface->image->bits_per_pixel == 4 || surface->image->bits_per_pixel == 8)
+            mapping = X11DRV_PALETTE_PaletteToXPixel;
+
+        src += rect->top * width_bytes;
+        dst += rect->top * width_bytes;
+        copy_image_byteswap( &surface->info, src, dst, width_bytes, width_bytes,
+                             rect->bottom - rect->top, surface->byteswap, mapping, ~0u );
+    }
+
+#ifdef HAVE_LIBXXSHM
+    if (surface->shminfo.shmid != -1)
+        XShmPutImage( gdi_display, surface->window, surface->gc, surface->image,
+                      rect->left, rect->top,
+                      surface->header.rect.left + rect->left, surface->header.rect.top + rect->top,
+                      rect->right - rect->left, rect->bottom - rect->top, False );
+    else
+#endif
+    XPutImage( gdi_display, surface->window, surface->gc, surface->image,
+               rect->left, rect->top,
+               surface->header.rect.left + rect->left, surface->header.rect.top + rect->top,
+               rect->right - rect->left, rect->bottom - rect->top );
+}
+
 /***********************************************************************
  *           x11drv_surface_flush
  */
 static void x11drv_surface_flush( struct window_surface *window_surface )
 {
     struct x11drv_window_surface *surface = get_x11_surface( window_surface );
-    unsigned char *src = surface->bits;
-    unsigned char *dst = (unsigned char *)surface->image->data;
-    struct bitblt_coords coords;
+    RECT rect, visrect;
+    int i, count = 0;
 
     window_surface->funcs->lock( window_surface );
-    coords.x = 0;
-    coords.y = 0;
-    coords.width  = surface->header.rect.right - surface->header.rect.left;
-    coords.height = surface->header.rect.bottom - surface->header.rect.top;
-    SetRect( &coords.visrect, 0, 0, coords.width, coords.height );
-    if (IntersectRect( &coords.visrect, &coords.visrect, &surface->bounds ))
+    if (!IsRectEmpty( &surface->bounds ))
     {
-        TRACE( "flushing %p %dx%d bounds %s bits %p\n",
-               surface, coords.width, coords.height,
-               wine_dbgstr_rect( &surface->bounds ), surface->bits );
-
-        if (surface->is_argb || surface->color_key != CLR_INVALID) update_surface_region( surface );
+        add_damage_rect( surface, &surface->bounds );
+        reset_bounds( &surface->bounds );
+    }
 
-        if (src != dst)
-        {
-            const int *mapping = NULL;
-            int width_bytes = surface->image->bytes_per_line;
+    SetRect( &rect, 0, 0, surface->header.rect.right - surface->header.rect.left,
+             surface->header.rect.bottom - surface->header.rect.top );
+    for (i = 0; i < surface->damage_count; i++)
+    {
+        if (!IntersectRect( &visrect, &rect, &surface->damage[i] )) continue;
 
-            if (surface->image->bits_per_pixel == 4 || surface->image->bits_per_pixel == 8)
-                mapping = X11DRV_PALETTE_PaletteToXPixel;
+        TRACE( "flushing %p %dx%d rect %s bits %p\n",
+               surface, rect.right, rect.bottom, wine_dbgstr_rect( &visrect ), surface->bits );
 
-            src += coords.visrect.top * width_bytes;
-            dst += coords.visrect.top * width_bytes;
-            copy_image_byteswap( &surface->info, src, dst, width_bytes, width_bytes,
-                                 coords.visrect.bottom - coords.visrect.top,
-                                 surface->byteswap, mapping, ~0u );
-        }
+        if (!count++ && (surface->is_argb || surface->color_key != CLR_INVALID))
+            update_surface_region( surface );
 
-#ifdef HAVE_LIBXXSHM
-        if (surface->shminfo.shmid != -1)
-            XShmPutImage( gdi_display, surface->window, surface->gc, surface->image,
-                          coords.visrect.left, coords.visrect.top,
-                          surface->header.rect.left + coords.visrect.left,
-                          surface->header.rect.top + coords.visrect.top,
-                          coords.visrect.right - coords.visrect.left,
-                          coords.visrect.bottom - coords.visrect.top, False );
-        else
-#endif
-        XPutImage( gdi_display, surface->window, surface->gc, surface->image,
-                   coords.visrect.left, coords.visrect.top,
-                   surface->header.rect.left + coords.visrect.left,
-                   surface->header.rect.top + coords.visrect.top,
-                   coords.visrect.right - coords.visrect.left,
-                   coords.visrect.bottom - coords.visrect.top );
-        XFlush( gdi_display );
+        put_surface_rect( surface, &visrect );
     }
-    reset_bounds( &surface->bounds );
+    if (count) XFlush( gdi_display );
+    surface->damage_count = 0;
     window_surface->funcs->unlock( window_surface );
 }
 
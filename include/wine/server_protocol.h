@@ -339,6 +339,33 @@ typedef union
 } message_data_t;
 
 
+typedef struct
+{
+    unsigned int   seq;
+    unsigned int   wake_bits;
+    unsigned int   changed_bits;
+} queue_shm_t;
+
+
+typedef struct
+{
+    unsigned int   seq;
+    user_handle_t  handle;
+    user_handle_t  parent;
+    user_handle_t  owner;
+    thread_id_t    tid;
+    process_id_t   pid;
+    unsigned int   style;
+    unsigned int   ex_style;
+    unsigned int   id;
+    int            is_unicode;
+    mod_handle_t   instance;
+    lparam_t       user_data;
+    rectangle_t    window;
+    rectangle_t    client;
+} window_shm_t;
+
+
 typedef struct
 {
     WCHAR          ch;
@@ -2235,7 +2262,9 @@ struct get_mapping_info_reply
     int          protect;
     obj_handle_t mapping;
     obj_handle_t shared_file;
+    obj_handle_t cache_file;
     /* VARARG(image,pe_image_info); */
+    char __pad_36[4];
 };
 
 
@@ -2913,7 +2942,7 @@ struct get_msg_queue_reply
 {
     struct reply_header __header;
     obj_handle_t handle;
-    char __pad_12[4];
+    obj_handle_t shm;
 };
 
 
@@ -3025,23 +3054,41 @@ struct send_hardware_message_request
     user_handle_t   win;
     hw_input_t      input;
     unsigned int    flags;
+    /* VARARG(more_input,hw_inputs); */
     char __pad_52[4];
 };
 struct send_hardware_message_reply
 {
     struct reply_header __header;
     int             wait;
+    unsigned int    count;
     int             prev_x;
     int             prev_y;
     int             new_x;
     int             new_y;
     /* VARARG(keystate,bytes); */
-    char __pad_28[4];
 };
 #define SEND_HWMSG_INJECTED    0x01
 
 
 
+struct get_rawinput_buffer_request
+{
+    struct request_header __header;
+    data_size_t     mouse_size;
+    data_size_t     keyboard_size;
+    data_size_t     buffer_size;
+};
+struct get_rawinput_buffer_reply
+{
+    struct reply_header __header;
+    data_size_t     next_size;
+    unsigned int    count;
+    /* VARARG(data,bytes); */
+};
+
+
+
 struct get_message_request
 {
     struct request_header __header;
@@ -3065,8 +3112,10 @@ struct get_message_reply
     int             y;
     unsigned int    time;
     unsigned int    active_hooks;
+    unsigned int    shm_seq;
     data_size_t     total;
     /* VARARG(data,message_data); */
+    char __pad_60[4];
 };
 
 
@@ -3433,6 +3482,20 @@ struct set_window_owner_reply
 
 
 
+struct get_window_shm_request
+{
+    struct request_header __header;
+    char __pad_12[4];
+};
+struct get_window_shm_reply
+{
+    struct reply_header __header;
+    obj_handle_t    handle;
+    char __pad_12[4];
+};
+
+
+
 struct get_window_info_request
 {
     struct request_header __header;
@@ -5686,6 +5749,7 @@ enum request
     REQ_send_message,
     REQ_post_quit_message,
     REQ_send_hardware_message,
+    REQ_get_rawinput_buffer,
     REQ_get_message,
     REQ_reply_message,
     REQ_accept_hardware_message,
@@ -5709,6 +5773,7 @@ enum request
     REQ_destroy_window,
     REQ_get_desktop_window,
     REQ_set_window_owner,
+    REQ_get_window_shm,
     REQ_get_window_info,
     REQ_set_window_info,
     REQ_set_parent,
@@ -5977,6 +6042,7 @@ union generic_request
     struct send_message_request send_message_request;
     struct post_quit_message_request post_quit_message_request;
     struct send_hardware_message_request send_hardware_message_request;
+    struct get_rawinput_buffer_request get_rawinput_buffer_request;
     struct get_message_request get_message_request;
     struct reply_message_request reply_message_request;
     struct accept_hardware_message_request accept_hardware_message_request;
@@ -6000,6 +6066,7 @@ union generic_request
     struct destroy_window_request destroy_window_request;
     struct get_desktop_window_request get_desktop_window_request;
     struct set_window_owner_request set_window_owner_request;
+    struct get_window_shm_request get_window_shm_request;
     struct get_window_info_request get_window_info_request;
     struct set_window_info_request set_window_info_request;
     struct set_parent_request set_parent_request;
@@ -6266,6 +6333,7 @@ union generic_reply
     struct send_message_reply send_message_reply;
     struct post_quit_message_reply post_quit_message_reply;
     struct send_hardware_message_reply send_hardware_message_reply;
+    struct get_rawinput_buffer_reply get_rawinput_buffer_reply;
     struct get_message_reply get_message_reply;
     struct reply_message_reply reply_message_reply;
     struct accept_hardware_message_reply accept_hardware_message_reply;
@@ -6289,6 +6357,7 @@ union generic_reply
     struct destroy_window_reply destroy_window_reply;
     struct get_desktop_window_reply get_desktop_window_reply;
     struct set_window_owner_reply set_window_owner_reply;
+    struct get_window_shm_reply get_window_shm_reply;
     struct get_window_info_reply get_window_info_reply;
     struct set_window_info_reply set_window_info_reply;
     struct set_parent_reply set_parent_reply;
@@ -6418,6 +6487,6 @@ union generic_reply
     struct terminate_job_reply terminate_job_reply;
 };
 
-#define SERVER_PROTOCOL_VERSION 532
+#define SERVER_PROTOCOL_VERSION 537
 
 #endif /* __WINE_WINE_SERVER_PROTOCOL_H */
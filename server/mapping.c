@@ -25,6 +25,7 @@
 #include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <fcntl.h>
 #include <sys/stat.h>
 #ifdef HAVE_SYS_MMAN_H
 # include <sys/mman.h>
@@ -65,8 +66,10 @@ struct mapping
     enum cpu_type   cpu;             /* client CPU (for PE image mapping) */
     pe_image_info_t image;           /* image info (for PE image mapping) */
     struct ranges  *committed;       /* list of committed ranges in this mapping */
+    time_t          mtime;           /* modification time of the file (for PE image mapping) */
     struct file    *shared_file;     /* temp file for shared PE mapping */
     struct list     shared_entry;    /* entry in global shared PE mappings list */
+    struct image_cache *cache;       /* cache of the unaligned image sections */
 };
 
 static void mapping_dump( struct object *obj, int verbose );
@@ -113,6 +116,39 @@ static const struct fd_ops mapping_fd_ops =
 
 static struct list shared_list = LIST_INIT(shared_list);
 
+/* page-aligned copy of the image sections that can't be mmapped directly from the file */
+struct image_cache
+{
+    struct list          entry;       /* entry in image_cache_list */
+    unsigned int         refcount;    /* number of image mappings using the cache */
+    dev_t                dev;         /* device of the image file */
+    ino_t                ino;         /* inode of the image file */
+    file_pos_t           file_size;   /* size of the image file */
+    time_t               mtime;       /* modification time of the image file */
+    mem_size_t           size;        /* total size of the cached sections */
+    struct file         *file;        /* read-only cache file, set once it has been filled */
+    int                  failed;      /* the cache could not be filled */
+    int                  image_fd;    /* unix fd of the image while the cache is being filled */
+    int                  write_fd;    /* unix fd used to fill the cache file */
+    int                  read_fd;     /* read-only unix fd of the cache file */
+    struct timeout_user *timeout;     /* timeout for the next fill step */
+    unsigned int         count;       /* number of sections to copy */
+    unsigned int         current;     /* section being copied */
+    size_t               copied;      /* bytes of the current section already copied */
+    struct cached_section
+    {
+        off_t            read_pos;    /* position of the section data in the image file */
+        off_t            write_pos;   /* position of the section in the cache file */
+        size_t           size;        /* size of the section data */
+    } sections[1];
+};
+
+static struct list image_cache_list = LIST_INIT(image_cache_list);
+static mem_size_t image_cache_total;    /* size of all the filled image caches */
+static mem_size_t image_cache_shared;   /* cached pages used by more than one image mapping */
+
+#define IMAGE_CACHE_CHUNK 0x40000  /* amount of data copied per fill step */
+
 static size_t page_mask;
 
 #define ROUND_SIZE(size)  (((size) + page_mask) & ~page_mask)
@@ -159,8 +195,8 @@ static int check_current_dir_for_exec(void)
     return (ret != MAP_FAILED);
 }
 
-/* create a temp file for anonymous mappings */
-static int create_temp_file( file_pos_t size )
+/* create a temp file for anonymous mappings, optionally with a read-only fd to it */
+static int create_temp_file( file_pos_t size, int *read_fd )
 {
     static int temp_dir_fd = -1;
     char tmpfn[] = "anonmap.XXXXXX";
@@ -189,6 +225,12 @@ static int create_temp_file( file_pos_t size )
             close( fd );
             fd = -1;
         }
+        else if (read_fd && (*read_fd = open( tmpfn, O_RDONLY )) == -1)
+        {
+            file_set_error();
+            close( fd );
+            fd = -1;
+        }
         unlink( tmpfn );
     }
     else file_set_error();
@@ -203,7 +245,8 @@ static struct file *get_shared_file( struct mapping *mapping )
     struct mapping *ptr;
 
     LIST_FOR_EACH_ENTRY( ptr, &shared_list, struct mapping, shared_entry )
-        if (is_same_file_fd( ptr->fd, mapping->fd ))
+        if (is_same_file_fd( ptr->fd, mapping->fd ) &&
+            ptr->image.file_size == mapping->image.file_size && ptr->mtime == mapping->mtime)
             return (struct file *)grab_object( ptr->shared_file );
     return NULL;
 }
@@ -222,6 +265,21 @@ static inline void get_section_sizes( const IMAGE_SECTION_HEADER *sec, size_t *m
     if (*file_size > *map_size) *file_size = *map_size;
 }
 
+/* check if a section is stored in the image cache */
+/* this must be kept in sync with map_image() in ntdll */
+static inline int is_section_cached( const IMAGE_SECTION_HEADER *sec, unsigned int section_align )
+{
+    size_t file_size, map_size;
+    off_t file_start;
+
+    if ((sec->Characteristics & IMAGE_SCN_MEM_SHARED) && (sec->Characteristics & IMAGE_SCN_MEM_WRITE))
+        return 0;
+    /* non page-aligned binaries are mapped as a whole by the client */
+    if (section_align <= page_mask) return 0;
+    get_section_sizes( sec, &map_size, &file_start, &file_size );
+    return sec->PointerToRawData && file_size && (file_start & page_mask);
+}
+
 /* add a range to the committed list */
 static void add_committed_range( struct mapping *mapping, file_pos_t start, file_pos_t end )
 {
@@ -328,7 +386,7 @@ static int build_shared_mapping( struct mapping *mapping, int fd,
 
     /* create a temp file for the mapping */
 
-    if ((shared_fd = create_temp_file( total_size )) == -1) return 0;
+    if ((shared_fd = create_temp_file( total_size, NULL )) == -1) return 0;
     if (!(mapping->shared_file = create_file_for_fd( shared_fd, FILE_GENERIC_READ|FILE_GENERIC_WRITE, 0 )))
         return 0;
 
@@ -370,9 +428,191 @@ static int build_shared_mapping( struct mapping *mapping, int fd,
     return 0;
 }
 
+/* trace the image cache totals */
+static void trace_image_cache( struct image_cache *cache, const char *action )
+{
+    if (debug_level)
+        fprintf( stderr, "wineserver: image cache %s (%u Kb), %u Kb cached, %u Kb shared\n", action,
+                 (unsigned int)(cache->size >> 10), (unsigned int)(image_cache_total >> 10),
+                 (unsigned int)(image_cache_shared >> 10) );
+}
+
+/* stop filling an image cache, it won't be used */
+static void abort_image_cache( struct image_cache *cache )
+{
+    if (cache->timeout) remove_timeout_user( cache->timeout );
+    cache->timeout = NULL;
+    if (cache->image_fd != -1) close( cache->image_fd );
+    if (cache->write_fd != -1) close( cache->write_fd );
+    if (cache->read_fd != -1) close( cache->read_fd );
+    cache->image_fd = cache->write_fd = cache->read_fd = -1;
+    cache->failed = 1;
+}
+
+/* copy a chunk of the image sections into the cache file; called from a timeout to keep requests flowing */
+static void fill_image_cache( void *private )
+{
+    struct image_cache *cache = private;
+    size_t size, todo = IMAGE_CACHE_CHUNK;
+    struct stat st;
+    char *buffer;
+    long res = 0;
+
+    cache->timeout = NULL;
+    if (!(buffer = malloc( IMAGE_CACHE_CHUNK ))) goto failed;
+
+    while (todo && cache->current < cache->count)
+    {
+        struct cached_section *sec = &cache->sections[cache->current];
+
+        size = min( todo, sec->size - cache->copied );
+        res = pread( cache->image_fd, buffer, size, sec->read_pos + cache->copied );
+        if (res < 0) break;
+        if (res && pwrite( cache->write_fd, buffer, res, sec->write_pos + cache->copied ) != res)
+        {
+            res = -1;
+            break;
+        }
+        /* truncated files are reported by the client, leave the rest zero-filled */
+        cache->copied = ((size_t)res < size) ? sec->size : cache->copied + res;
+        if (cache->copied == sec->size)
+        {
+            cache->current++;
+            cache->copied = 0;
+        }
+        todo -= size;
+    }
+    free( buffer );
+    if (res < 0) goto failed;
+
+    if (cache->current < cache->count)
+    {
+        if (!(cache->timeout = add_timeout_user( 0, fill_image_cache, cache ))) goto failed;
+        return;
+    }
+
+    /* don't publish the copy if the image was rewritten while we were reading it */
+    if (fstat( cache->image_fd, &st ) == -1 || st.st_size != cache->file_size || st.st_mtime != cache->mtime)
+        goto failed;
+
+    close( cache->image_fd );
+    close( cache->write_fd );
+    cache->image_fd = cache->write_fd = -1;
+    cache->file = create_file_for_fd( cache->read_fd, FILE_GENERIC_READ, 0 );
+    cache->read_fd = -1;
+    if (!cache->file) goto failed;
+
+    image_cache_total += cache->size;
+    image_cache_shared += cache->size * (cache->refcount - 1);
+    trace_image_cache( cache, "filled" );
+    return;
+
+failed:
+    abort_image_cache( cache );
+    clear_error();
+}
+
+/* start filling an image cache in the background */
+static void start_image_cache( struct image_cache *cache, int unix_fd )
+{
+    if ((cache->image_fd = dup( unix_fd )) == -1) goto failed;
+    if ((cache->write_fd = create_temp_file( cache->size, &cache->read_fd )) == -1) goto failed;
+    if (!(cache->timeout = add_timeout_user( 0, fill_image_cache, cache ))) goto failed;
+    return;
+
+failed:
+    abort_image_cache( cache );
+    clear_error();
+}
+
+/* find the image cache for a given image file */
+static struct image_cache *find_image_cache( const struct stat *st )
+{
+    struct image_cache *cache;
+
+    LIST_FOR_EACH_ENTRY( cache, &image_cache_list, struct image_cache, entry )
+        if (cache->dev == st->st_dev && cache->ino == st->st_ino &&
+            cache->file_size == st->st_size && cache->mtime == st->st_mtime)
+            return cache;
+    return NULL;
+}
+
+/* attach the image cache to a mapping, creating it if needed */
+/* the sections are only copied once a second mapping of the same image shows up */
+static void get_image_cache( struct mapping *mapping, const struct stat *st, int unix_fd,
+                             IMAGE_SECTION_HEADER *sec, unsigned int nb_sec, unsigned int section_align )
+{
+    struct image_cache *cache;
+    size_t file_size, map_size;
+    off_t file_start;
+    mem_size_t pos;
+    unsigned int i, count;
+
+    if ((cache = find_image_cache( st )))
+    {
+        if (cache->file) image_cache_shared += cache->size;
+        cache->refcount++;
+        if (cache->refcount == 2 && !cache->failed && !cache->file && !cache->timeout)
+            start_image_cache( cache, unix_fd );
+        mapping->cache = cache;
+        return;
+    }
+
+    for (i = count = 0; i < nb_sec; i++) if (is_section_cached( &sec[i], section_align )) count++;
+    if (!count) return;  /* nothing to cache */
+
+    if (!(cache = malloc( offsetof( struct image_cache, sections[count] )))) return;
+    cache->refcount  = 1;
+    cache->dev       = st->st_dev;
+    cache->ino       = st->st_ino;
+    cache->file_size = st->st_size;
+    cache->mtime     = st->st_mtime;
+    cache->file      = NULL;
+    cache->failed    = 0;
+    cache->image_fd  = cache->write_fd = cache->read_fd = -1;
+    cache->timeout   = NULL;
+    cache->count     = count;
+    cache->current   = 0;
+    cache->copied    = 0;
+
+    for (i = count = 0, pos = 0; i < nb_sec; i++)
+    {
+        if (!is_section_cached( &sec[i], section_align )) continue;
+        get_section_sizes( &sec[i], &map_size, &file_start, &file_size );
+        cache->sections[count].read_pos  = file_start;
+        cache->sections[count].write_pos = pos;
+        cache->sections[count].size      = file_size;
+        count++;
+        pos += map_size;
+    }
+    cache->size = pos;
+    list_add_head( &image_cache_list, &cache->entry );
+    mapping->cache = cache;
+}
+
+/* release a mapping's reference to its image cache */
+static void release_image_cache( struct image_cache *cache )
+{
+    if (--cache->refcount)
+    {
+        if (cache->file) image_cache_shared -= cache->size;
+        return;
+    }
+    if (cache->file)
+    {
+        image_cache_total -= cache->size;
+        trace_image_cache( cache, "freed" );
+        release_object( cache->file );
+    }
+    abort_image_cache( cache );
+    list_remove( &cache->entry );
+    free( cache );
+}
+
 /* retrieve the mapping parameters for an executable (PE) image */
-static unsigned int get_image_params( struct mapping *mapping, file_pos_t file_size, int unix_fd )
+static unsigned int get_image_params( struct mapping *mapping, const struct stat *st, int unix_fd )
 {
+    file_pos_t file_size = st->st_size;
     IMAGE_DOS_HEADER dos;
     IMAGE_SECTION_HEADER *sec = NULL;
     struct
@@ -473,6 +713,7 @@ static unsigned int get_image_params( struct mapping *mapping, file_pos_t file_s
     mapping->image.contains_code = 0; /* FIXME */
     mapping->image.image_flags   = 0; /* FIXME */
     mapping->image.file_size     = file_size;
+    mapping->mtime               = st->st_mtime;
 
     /* load the section headers */
 
@@ -489,6 +730,9 @@ static unsigned int get_image_params( struct mapping *mapping, file_pos_t file_s
 
     if (mapping->shared_file) list_add_head( &shared_list, &mapping->shared_entry );
 
+    get_image_cache( mapping, st, unix_fd, sec, nt.FileHeader.NumberOfSections,
+                     nt.opt.hdr32.SectionAlignment );
+
     free( sec );
     return 0;
 
@@ -520,6 +764,7 @@ static struct object *create_mapping( struct object *root, const struct unicode_
     mapping->protect     = protect;
     mapping->fd          = NULL;
     mapping->shared_file = NULL;
+    mapping->cache       = NULL;
     mapping->committed   = NULL;
 
     if (protect & VPROT_READ) access |= FILE_READ_DATA;
@@ -560,7 +805,7 @@ static struct object *create_mapping( struct object *root, const struct unicode_
         }
         if (flags & SEC_IMAGE)
         {
-            unsigned int err = get_image_params( mapping, st.st_size, unix_fd );
+            unsigned int err = get_image_params( mapping, &st, unix_fd );
             if (!err) return &mapping->obj;
             set_error( err );
             goto error;
@@ -598,7 +843,7 @@ static struct object *create_mapping( struct object *root, const struct unicode_
             mapping->committed->max   = 8;
         }
         mapping->size = (mapping->size + page_mask) & ~((mem_size_t)page_mask);
-        if ((unix_fd = create_temp_file( mapping->size )) == -1) goto error;
+        if ((unix_fd = create_temp_file( mapping->size, NULL )) == -1) goto error;
         if (!(mapping->fd = create_anonymous_fd( &mapping_fd_ops, unix_fd, &mapping->obj,
                                                  FILE_SYNCHRONOUS_IO_NONALERT ))) goto error;
         allow_fd_caching( mapping->fd );
@@ -610,6 +855,27 @@ static struct object *create_mapping( struct object *root, const struct unicode_
     return NULL;
 }
 
+/* create an anonymous mapping that is also mapped in the server address space */
+/* the server can use it to export read-only data to the clients */
+struct object *create_shared_mapping( mem_size_t size, void **ptr )
+{
+    struct object *obj;
+    struct mapping *mapping;
+    int unix_fd;
+
+    if (!(obj = create_mapping( NULL, NULL, 0, size, SEC_COMMIT, VPROT_READ | VPROT_WRITE, 0, NULL )))
+        return NULL;
+    mapping = (struct mapping *)obj;
+    if ((unix_fd = get_unix_fd( mapping->fd )) != -1)
+    {
+        *ptr = mmap( NULL, mapping->size, PROT_READ | PROT_WRITE, MAP_SHARED, unix_fd, 0 );
+        if (*ptr != MAP_FAILED) return obj;
+        file_set_error();
+    }
+    release_object( obj );
+    return NULL;
+}
+
 struct mapping *get_mapping_obj( struct process *process, obj_handle_t handle, unsigned int access )
 {
     return (struct mapping *)get_handle_obj( process, handle, access, &mapping_ops );
@@ -675,6 +941,7 @@ static void mapping_destroy( struct object *obj )
         release_object( mapping->shared_file );
         list_remove( &mapping->shared_entry );
     }
+    if (mapping->cache) release_image_cache( mapping->cache );
     free( mapping->committed );
 }
 
@@ -763,6 +1030,12 @@ DECL_HANDLER(get_mapping_info)
             if (reply->mapping) close_handle( current->process, reply->mapping );
         }
     }
+    if (!get_error() && mapping->cache && mapping->cache->file)
+    {
+        /* the cache is optional, the client falls back to reading the image */
+        if (!(reply->cache_file = alloc_handle( current->process, mapping->cache->file, GENERIC_READ, 0 )))
+            clear_error();
+    }
     release_object( mapping );
 }
 
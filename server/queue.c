@@ -28,6 +28,9 @@
 #ifdef HAVE_POLL_H
 # include <poll.h>
 #endif
+#ifdef HAVE_SYS_MMAN_H
+# include <sys/mman.h>
+#endif
 
 #include "ntstatus.h"
 #define WIN32_NO_STATUS
@@ -140,6 +143,8 @@ struct msg_queue
     struct thread_input   *input;           /* thread input descriptor */
     struct hook_table     *hooks;           /* hook table */
     timeout_t              last_get_msg;    /* time of last get message call */
+    struct object         *shm_mapping;     /* mapping for the state shared with the client */
+    volatile queue_shm_t  *shm;             /* state shared with the client */
 };
 
 struct hotkey
@@ -298,6 +303,11 @@ static struct msg_queue *create_msg_queue( struct thread *thread, struct thread_
         queue->input           = (struct thread_input *)grab_object( input );
         queue->hooks           = NULL;
         queue->last_get_msg    = current_time;
+        queue->shm             = NULL;
+        /* this costs a temp file, a server fd and a page per queue; queues are
+         * only created for threads that use window messages */
+        queue->shm_mapping     = create_shared_mapping( sizeof(*queue->shm), (void **)&queue->shm );
+        if (!queue->shm_mapping) clear_error();  /* the client will always use the server instead */
         list_init( &queue->send_result );
         list_init( &queue->callback_result );
         list_init( &queue->pending_timers );
@@ -429,6 +439,18 @@ void set_queue_hooks( struct thread *thread, struct hook_table *hooks )
     queue->hooks = hooks;
 }
 
+/* update the queue state shared with the client */
+static void update_shared_queue( struct msg_queue *queue )
+{
+    volatile queue_shm_t *shm = queue->shm;
+
+    if (!shm) return;
+    interlocked_xchg_add( (int *)&shm->seq, 1 );
+    shm->wake_bits    = queue->wake_bits;
+    shm->changed_bits = queue->changed_bits;
+    interlocked_xchg_add( (int *)&shm->seq, 1 );
+}
+
 /* check the queue status */
 static inline int is_signaled( struct msg_queue *queue )
 {
@@ -440,6 +462,7 @@ static inline void set_queue_bits( struct msg_queue *queue, unsigned int bits )
 {
     queue->wake_bits |= bits;
     queue->changed_bits |= bits;
+    update_shared_queue( queue );
     if (is_signaled( queue )) wake_up( &queue->obj, 0 );
 }
 
@@ -448,6 +471,7 @@ static inline void clear_queue_bits( struct msg_queue *queue, unsigned int bits
 {
     queue->wake_bits &= ~bits;
     queue->changed_bits &= ~bits;
+    update_shared_queue( queue );
 }
 
 /* check whether msg is a keyboard message */
@@ -995,6 +1019,11 @@ static void msg_queue_destroy( struct object *obj )
     release_object( queue->input );
     if (queue->hooks) release_object( queue->hooks );
     if (queue->fd) release_object( queue->fd );
+    if (queue->shm_mapping)
+    {
+        munmap( (void *)queue->shm, sizeof(*queue->shm) );
+        release_object( queue->shm_mapping );
+    }
 }
 
 static void msg_queue_poll_event( struct fd *fd, int event )
@@ -2218,7 +2247,11 @@ DECL_HANDLER(get_msg_queue)
     struct msg_queue *queue = get_current_queue();
 
     reply->handle = 0;
-    if (queue) reply->handle = alloc_handle( current->process, queue, SYNCHRONIZE, 0 );
+    reply->shm = 0;
+    if (!queue) return;
+    reply->handle = alloc_handle( current->process, queue, SYNCHRONIZE, 0 );
+    if (queue->shm_mapping)
+        reply->shm = alloc_handle( current->process, queue->shm_mapping, SECTION_QUERY | SECTION_MAP_READ, 0 );
 }
 
 
@@ -2277,6 +2310,7 @@ DECL_HANDLER(get_queue_status)
         reply->wake_bits    = queue->wake_bits;
         reply->changed_bits = queue->changed_bits;
         queue->changed_bits &= ~req->clear_bits;
+        update_shared_queue( queue );
     }
     else reply->wake_bits = reply->changed_bits = 0;
 }
@@ -2368,6 +2402,9 @@ DECL_HANDLER(send_hardware_message)
     struct thread *thread = NULL;
     struct desktop *desktop;
     struct msg_queue *sender = get_current_queue();
+    const hw_input_t *input = &req->input;
+    const hw_input_t *more_input = get_req_data();
+    unsigned int i, more_count = get_req_data_size() / sizeof(*more_input);
     data_size_t size = min( 256, get_reply_max_size() );
 
     if (!(desktop = get_thread_desktop( current, 0 ))) return;
@@ -2378,6 +2415,8 @@ DECL_HANDLER(send_hardware_message)
         if (desktop != thread->queue->input->desktop)
         {
             /* don't allow queuing events to a different desktop */
+            set_error( STATUS_ACCESS_DENIED );
+            release_object( thread );
             release_object( desktop );
             return;
         }
@@ -2386,19 +2425,27 @@ DECL_HANDLER(send_hardware_message)
     reply->prev_x = desktop->cursor.x;
     reply->prev_y = desktop->cursor.y;
 
-    switch (req->input.type)
+    /* queue the inputs in order, stopping at the first one that has to
+     * wait for a low-level hook so that the client can resume from there */
+    for (i = 0; ; input = &more_input[i++])
     {
-    case INPUT_MOUSE:
-        reply->wait = queue_mouse_message( desktop, req->win, &req->input, req->flags, sender );
-        break;
-    case INPUT_KEYBOARD:
-        reply->wait = queue_keyboard_message( desktop, req->win, &req->input, req->flags, sender );
-        break;
-    case INPUT_HARDWARE:
-        queue_custom_hardware_message( desktop, req->win, &req->input );
-        break;
-    default:
-        set_error( STATUS_INVALID_PARAMETER );
+        switch (input->type)
+        {
+        case INPUT_MOUSE:
+            reply->wait = queue_mouse_message( desktop, req->win, input, req->flags, sender );
+            break;
+        case INPUT_KEYBOARD:
+            reply->wait = queue_keyboard_message( desktop, req->win, input, req->flags, sender );
+            break;
+        case INPUT_HARDWARE:
+            queue_custom_hardware_message( desktop, req->win, input );
+            break;
+        default:
+            set_error( STATUS_INVALID_PARAMETER );
+        }
+        if (get_error()) break;
+        reply->count++;
+        if (reply->wait || i == more_count) break;
     }
     if (thread) release_object( thread );
 
@@ -2408,6 +2455,76 @@ DECL_HANDLER(send_hardware_message)
     release_object( desktop );
 }
 
+/* retrieve the pending raw input messages of the current thread */
+DECL_HANDLER(get_rawinput_buffer)
+{
+    struct thread_input *input;
+    struct hardware_msg_data *buf = NULL;
+    struct thread *win_thread;
+    struct list *ptr, *next;
+    user_handle_t win;
+    unsigned int msg_code, count = 0, max_count = 0, min_size;
+    data_size_t size, total = 0;
+    int remaining = 0;
+
+    if (!current->queue) return;
+    input = current->queue->input;
+
+    min_size = min( req->mouse_size, req->keyboard_size );
+    if (min_size) max_count = req->buffer_size / min_size;
+    max_count = min( max_count, get_reply_max_size() / sizeof(*buf) );
+    if (max_count && !(buf = mem_alloc( max_count * sizeof(*buf) ))) return;
+
+    LIST_FOR_EACH_SAFE( ptr, next, &input->msg_list )
+    {
+        struct message *msg = LIST_ENTRY( ptr, struct message, entry );
+        struct hardware_msg_data *data = msg->data;
+
+        if (msg->msg != WM_INPUT) continue;
+        /* messages for other threads are left for get_hardware_message to dispatch */
+        win = find_hardware_message_window( input->desktop, input, msg, &msg_code, &win_thread );
+        if (!win_thread) continue;
+        release_object( win_thread );
+        if (!win || win_thread != current) continue;
+
+        size = data->rawinput.type == RIM_TYPEMOUSE ? req->mouse_size : req->keyboard_size;
+        if (count == max_count || total + size > req->buffer_size)
+        {
+            reply->next_size = size;
+            remaining = 1;
+            break;
+        }
+        memcpy( &buf[count++], data, sizeof(*buf) );
+        total += size;
+        list_remove( &msg->entry );
+        free_message( msg );
+    }
+
+    if (!remaining)
+    {
+        /* check whether the buffer now holds the last raw input for this thread */
+        LIST_FOR_EACH( ptr, &input->msg_list )
+        {
+            struct message *msg = LIST_ENTRY( ptr, struct message, entry );
+
+            if (get_hardware_msg_bit( msg ) != QS_RAWINPUT) continue;
+            win = find_hardware_message_window( input->desktop, input, msg, &msg_code, &win_thread );
+            if (!win_thread) continue;
+            release_object( win_thread );
+            if (win && win_thread == current)
+            {
+                remaining = 1;
+                break;
+            }
+        }
+    }
+    if (!remaining) clear_queue_bits( current->queue, QS_RAWINPUT );
+
+    reply->count = count;
+    if (count) set_reply_data_ptr( buf, count * sizeof(*buf) );
+    else free( buf );
+}
+
 /* post a quit message to the current queue */
 DECL_HANDLER(post_quit_message)
 {
@@ -2452,6 +2569,7 @@ DECL_HANDLER(get_message)
     }
     if (filter & QS_INPUT) queue->changed_bits &= ~QS_INPUT;
     if (filter & QS_PAINT) queue->changed_bits &= ~QS_PAINT;
+    update_shared_queue( queue );
 
     /* then check for posted messages */
     if ((filter & QS_POSTMESSAGE) &&
@@ -2506,6 +2624,7 @@ DECL_HANDLER(get_message)
     if (get_win == -1 && current->process->idle_event) set_event( current->process->idle_event );
     queue->wake_mask = req->wake_mask;
     queue->changed_mask = req->changed_mask;
+    if (queue->shm) reply->shm_seq = queue->shm->seq;
     set_error( STATUS_PENDING );  /* FIXME */
 }
 
@@ -246,6 +246,7 @@ DECL_HANDLER(get_process_idle_event);
 DECL_HANDLER(send_message);
 DECL_HANDLER(post_quit_message);
 DECL_HANDLER(send_hardware_message);
+DECL_HANDLER(get_rawinput_buffer);
 DECL_HANDLER(get_message);
 DECL_HANDLER(reply_message);
 DECL_HANDLER(accept_hardware_message);
@@ -269,6 +270,7 @@ DECL_HANDLER(create_window);
 DECL_HANDLER(destroy_window);
 DECL_HANDLER(get_desktop_window);
 DECL_HANDLER(set_window_owner);
+DECL_HANDLER(get_window_shm);
 DECL_HANDLER(get_window_info);
 DECL_HANDLER(set_window_info);
 DECL_HANDLER(set_parent);
@@ -536,6 +538,7 @@ static const req_handler req_handlers[REQ_NB_REQUESTS] =
     (req_handler)req_send_message,
     (req_handler)req_post_quit_message,
     (req_handler)req_send_hardware_message,
+    (req_handler)req_get_rawinput_buffer,
     (req_handler)req_get_message,
     (req_handler)req_reply_message,
     (req_handler)req_accept_hardware_message,
@@ -559,6 +562,7 @@ static const req_handler req_handlers[REQ_NB_REQUESTS] =
     (req_handler)req_destroy_window,
     (req_handler)req_get_desktop_window,
     (req_handler)req_set_window_owner,
+    (req_handler)req_get_window_shm,
     (req_handler)req_get_window_info,
     (req_handler)req_set_window_info,
     (req_handler)req_set_parent,
@@ -1264,7 +1268,8 @@ C_ASSERT( FIELD_OFFSET(struct get_mapping_info_reply, flags) == 16 );
 C_ASSERT( FIELD_OFFSET(struct get_mapping_info_reply, protect) == 20 );
 C_ASSERT( FIELD_OFFSET(struct get_mapping_info_reply, mapping) == 24 );
 C_ASSERT( FIELD_OFFSET(struct get_mapping_info_reply, shared_file) == 28 );
-C_ASSERT( sizeof(struct get_mapping_info_reply) == 32 );
+C_ASSERT( FIELD_OFFSET(struct get_mapping_info_reply, cache_file) == 32 );
+C_ASSERT( sizeof(struct get_mapping_info_reply) == 40 );
 C_ASSERT( FIELD_OFFSET(struct get_mapping_committed_range_request, handle) == 12 );
 C_ASSERT( FIELD_OFFSET(struct get_mapping_committed_range_request, offset) == 16 );
 C_ASSERT( sizeof(struct get_mapping_committed_range_request) == 24 );
@@ -1476,6 +1481,7 @@ C_ASSERT( FIELD_OFFSET(struct init_atom_table_reply, table) == 8 );
 C_ASSERT( sizeof(struct init_atom_table_reply) == 16 );
 C_ASSERT( sizeof(struct get_msg_queue_request) == 16 );
 C_ASSERT( FIELD_OFFSET(struct get_msg_queue_reply, handle) == 8 );
+C_ASSERT( FIELD_OFFSET(struct get_msg_queue_reply, shm) == 12 );
 C_ASSERT( sizeof(struct get_msg_queue_reply) == 16 );
 C_ASSERT( FIELD_OFFSET(struct set_queue_fd_request, handle) == 12 );
 C_ASSERT( sizeof(struct set_queue_fd_request) == 16 );
@@ -1511,11 +1517,19 @@ C_ASSERT( FIELD_OFFSET(struct send_hardware_message_request, input) == 16 );
 C_ASSERT( FIELD_OFFSET(struct send_hardware_message_request, flags) == 48 );
 C_ASSERT( sizeof(struct send_hardware_message_request) == 56 );
 C_ASSERT( FIELD_OFFSET(struct send_hardware_message_reply, wait) == 8 );
-C_ASSERT( FIELD_OFFSET(struct send_hardware_message_reply, prev_x) == 12 );
-C_ASSERT( FIELD_OFFSET(struct send_hardware_message_reply, prev_y) == 16 );
-C_ASSERT( FIELD_OFFSET(struct send_hardware_message_reply, new_x) == 20 );
-C_ASSERT( FIELD_OFFSET(struct send_hardware_message_reply, new_y) == 24 );
+C_ASSERT( FIELD_OFFSET(struct send_hardware_message_reply, count) == 12 );
+C_ASSERT( FIELD_OFFSET(struct send_hardware_message_reply, prev_x) == 16 );
+C_ASSERT( FIELD_OFFSET(struct send_hardware_message_reply, prev_y) == 20 );
+C_ASSERT( FIELD_OFFSET(struct send_hardware_message_reply, new_x) == 24 );
+C_ASSERT( FIELD_OFFSET(struct send_hardware_message_reply, new_y) == 28 );
 C_ASSERT( sizeof(struct send_hardware_message_reply) == 32 );
+C_ASSERT( FIELD_OFFSET(struct get_rawinput_buffer_request, mouse_size) == 12 );
+C_ASSERT( FIELD_OFFSET(struct get_rawinput_buffer_request, keyboard_size) == 16 );
+C_ASSERT( FIELD_OFFSET(struct get_rawinput_buffer_request, buffer_size) == 20 );
+C_ASSERT( sizeof(struct get_rawinput_buffer_request) == 24 );
+C_ASSERT( FIELD_OFFSET(struct get_rawinput_buffer_reply, next_size) == 8 );
+C_ASSERT( FIELD_OFFSET(struct get_rawinput_buffer_reply, count) == 12 );
+C_ASSERT( sizeof(struct get_rawinput_buffer_reply) == 16 );
 C_ASSERT( FIELD_OFFSET(struct get_message_request, flags) == 12 );
 C_ASSERT( FIELD_OFFSET(struct get_message_request, get_win) == 16 );
 C_ASSERT( FIELD_OFFSET(struct get_message_request, get_first) == 20 );
@@ -1533,8 +1547,9 @@ C_ASSERT( FIELD_OFFSET(struct get_message_reply, x) == 36 );
 C_ASSERT( FIELD_OFFSET(struct get_message_reply, y) == 40 );
 C_ASSERT( FIELD_OFFSET(struct get_message_reply, time) == 44 );
 C_ASSERT( FIELD_OFFSET(struct get_message_reply, active_hooks) == 48 );
-C_ASSERT( FIELD_OFFSET(struct get_message_reply, total) == 52 );
-C_ASSERT( sizeof(struct get_message_reply) == 56 );
+C_ASSERT( FIELD_OFFSET(struct get_message_reply, shm_seq) == 52 );
+C_ASSERT( FIELD_OFFSET(struct get_message_reply, total) == 56 );
+C_ASSERT( sizeof(struct get_message_reply) == 64 );
 C_ASSERT( FIELD_OFFSET(struct reply_message_request, remove) == 12 );
 C_ASSERT( FIELD_OFFSET(struct reply_message_request, result) == 16 );
 C_ASSERT( sizeof(struct reply_message_request) == 24 );
@@ -1654,6 +1669,9 @@ C_ASSERT( sizeof(struct set_window_owner_request) == 24 );
 C_ASSERT( FIELD_OFFSET(struct set_window_owner_reply, full_owner) == 8 );
 C_ASSERT( FIELD_OFFSET(struct set_window_owner_reply, prev_owner) == 12 );
 C_ASSERT( sizeof(struct set_window_owner_reply) == 16 );
+C_ASSERT( sizeof(struct get_window_shm_request) == 16 );
+C_ASSERT( FIELD_OFFSET(struct get_window_shm_reply, handle) == 8 );
+C_ASSERT( sizeof(struct get_window_shm_reply) == 16 );
 C_ASSERT( FIELD_OFFSET(struct get_window_info_request, handle) == 12 );
 C_ASSERT( sizeof(struct get_window_info_request) == 16 );
 C_ASSERT( FIELD_OFFSET(struct get_window_info_reply, full_handle) == 8 );
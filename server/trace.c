@@ -390,6 +390,22 @@ static void dump_hw_input( const char *prefix, const hw_input_t *input )
     }
 }
 
+static void dump_varargs_hw_inputs( const char *prefix, data_size_t size )
+{
+    const hw_input_t *input;
+
+    fprintf( stderr, "%s{", prefix );
+    while (size >= sizeof(*input))
+    {
+        input = cur_data;
+        dump_hw_input( "", input );
+        size -= sizeof(*input);
+        remove_data( sizeof(*input) );
+        if (size) fputc( ',', stderr );
+    }
+    fputc( '}', stderr );
+}
+
 static void dump_luid( const char *prefix, const luid_t *luid )
 {
     fprintf( stderr, "%s%d.%u", prefix, luid->high_part, luid->low_part );
@@ -2236,6 +2252,7 @@ static void dump_get_mapping_info_reply( const struct get_mapping_info_reply *re
     fprintf( stderr, ", protect=%d", req->protect );
     fprintf( stderr, ", mapping=%04x", req->mapping );
     fprintf( stderr, ", shared_file=%04x", req->shared_file );
+    fprintf( stderr, ", cache_file=%04x", req->cache_file );
     dump_varargs_pe_image_info( ", image=", cur_size );
 }
 
@@ -2686,6 +2703,7 @@ static void dump_get_msg_queue_request( const struct get_msg_queue_request *req
 static void dump_get_msg_queue_reply( const struct get_msg_queue_reply *req )
 {
     fprintf( stderr, " handle=%04x", req->handle );
+    fprintf( stderr, ", shm=%04x", req->shm );
 }
 
 static void dump_set_queue_fd_request( const struct set_queue_fd_request *req )
@@ -2750,11 +2768,13 @@ static void dump_send_hardware_message_request( const struct send_hardware_messa
     fprintf( stderr, " win=%08x", req->win );
     dump_hw_input( ", input=", &req->input );
     fprintf( stderr, ", flags=%08x", req->flags );
+    dump_varargs_hw_inputs( ", more_input=", cur_size );
 }
 
 static void dump_send_hardware_message_reply( const struct send_hardware_message_reply *req )
 {
     fprintf( stderr, " wait=%d", req->wait );
+    fprintf( stderr, ", count=%08x", req->count );
     fprintf( stderr, ", prev_x=%d", req->prev_x );
     fprintf( stderr, ", prev_y=%d", req->prev_y );
     fprintf( stderr, ", new_x=%d", req->new_x );
@@ -2762,6 +2782,20 @@ static void dump_send_hardware_message_reply( const struct send_hardware_message
     dump_varargs_bytes( ", keystate=", cur_size );
 }
 
+static void dump_get_rawinput_buffer_request( const struct get_rawinput_buffer_request *req )
+{
+    fprintf( stderr, " mouse_size=%u", req->mouse_size );
+    fprintf( stderr, ", keyboard_size=%u", req->keyboard_size );
+    fprintf( stderr, ", buffer_size=%u", req->buffer_size );
+}
+
+static void dump_get_rawinput_buffer_reply( const struct get_rawinput_buffer_reply *req )
+{
+    fprintf( stderr, " next_size=%u", req->next_size );
+    fprintf( stderr, ", count=%08x", req->count );
+    dump_varargs_bytes( ", data=", cur_size );
+}
+
 static void dump_get_message_request( const struct get_message_request *req )
 {
     fprintf( stderr, " flags=%08x", req->flags );
@@ -2784,6 +2818,7 @@ static void dump_get_message_reply( const struct get_message_reply *req )
     fprintf( stderr, ", y=%d", req->y );
     fprintf( stderr, ", time=%08x", req->time );
     fprintf( stderr, ", active_hooks=%08x", req->active_hooks );
+    fprintf( stderr, ", shm_seq=%08x", req->shm_seq );
     fprintf( stderr, ", total=%u", req->total );
     dump_varargs_message_data( ", data=", cur_size );
 }
@@ -3022,6 +3057,15 @@ static void dump_set_window_owner_reply( const struct set_window_owner_reply *re
     fprintf( stderr, ", prev_owner=%08x", req->prev_owner );
 }
 
+static void dump_get_window_shm_request( const struct get_window_shm_request *req )
+{
+}
+
+static void dump_get_window_shm_reply( const struct get_window_shm_reply *req )
+{
+    fprintf( stderr, " handle=%04x", req->handle );
+}
+
 static void dump_get_window_info_request( const struct get_window_info_request *req )
 {
     fprintf( stderr, " handle=%08x", req->handle );
@@ -4598,6 +4642,7 @@ static const dump_func req_dumpers[REQ_NB_REQUESTS] = {
     (dump_func)dump_send_message_request,
     (dump_func)dump_post_quit_message_request,
     (dump_func)dump_send_hardware_message_request,
+    (dump_func)dump_get_rawinput_buffer_request,
     (dump_func)dump_get_message_request,
     (dump_func)dump_reply_message_request,
     (dump_func)dump_accept_hardware_message_request,
@@ -4621,6 +4666,7 @@ static const dump_func req_dumpers[REQ_NB_REQUESTS] = {
     (dump_func)dump_destroy_window_request,
     (dump_func)dump_get_desktop_window_request,
     (dump_func)dump_set_window_owner_request,
+    (dump_func)dump_get_window_shm_request,
     (dump_func)dump_get_window_info_request,
     (dump_func)dump_set_window_info_request,
     (dump_func)dump_set_parent_request,
@@ -4885,6 +4931,7 @@ static const dump_func reply_dumpers[REQ_NB_REQUESTS] = {
     NULL,
     NULL,
     (dump_func)dump_send_hardware_message_reply,
+    (dump_func)dump_get_rawinput_buffer_reply,
     (dump_func)dump_get_message_reply,
     NULL,
     NULL,
@@ -4908,6 +4955,7 @@ static const dump_func reply_dumpers[REQ_NB_REQUESTS] = {
     NULL,
     (dump_func)dump_get_desktop_window_reply,
     (dump_func)dump_set_window_owner_reply,
+    (dump_func)dump_get_window_shm_reply,
     (dump_func)dump_get_window_info_reply,
     (dump_func)dump_set_window_info_reply,
     (dump_func)dump_set_parent_reply,
@@ -5172,6 +5220,7 @@ static const char * const req_names[REQ_NB_REQUESTS] = {
     "send_message",
     "post_quit_message",
     "send_hardware_message",
+    "get_rawinput_buffer",
     "get_message",
     "reply_message",
     "accept_hardware_message",
@@ -5195,6 +5244,7 @@ static const char * const req_names[REQ_NB_REQUESTS] = {
     "destroy_window",
     "get_desktop_window",
     "set_window_owner",
+    "get_window_shm",
     "get_window_info",
     "set_window_info",
     "set_parent",
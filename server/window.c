@@ -33,6 +33,8 @@
 #include "winternl.h"
 
 #include "object.h"
+#include "file.h"
+#include "handle.h"
 #include "request.h"
 #include "thread.h"
 #include "process.h"
@@ -118,6 +120,12 @@ static struct window *shell_listview;
 static struct window *progman_window;
 static struct window *taskman_window;
 
+/* window state shared with the clients */
+static struct object *window_shm_mapping;
+static volatile window_shm_t *window_shm;
+
+#define WINDOW_SHM_ENTRIES ((LAST_USER_HANDLE - FIRST_USER_HANDLE + 1) >> 1)
+
 /* magic HWND_TOP etc. pointers */
 #define WINPTR_TOP       ((struct window *)1L)
 #define WINPTR_BOTTOM    ((struct window *)2L)
@@ -138,6 +146,58 @@ static inline int is_desktop_window( const struct window *win )
     return !win->parent;  /* only desktop windows have no parent */
 }
 
+/* create the mapping of the shared window state */
+static int init_window_shm(void)
+{
+    void *ptr;
+
+    if (window_shm) return 1;
+    if (!(window_shm_mapping = create_shared_mapping( WINDOW_SHM_ENTRIES * sizeof(window_shm_t), &ptr )))
+    {
+        clear_error();
+        return 0;
+    }
+    make_object_static( window_shm_mapping );
+    window_shm = ptr;
+    return 1;
+}
+
+/* update the state of a window shared with the clients */
+static void update_window_shm( struct window *win )
+{
+    volatile window_shm_t *shm;
+
+    if (!window_shm) return;
+    shm = &window_shm[((win->handle & 0xffff) - FIRST_USER_HANDLE) >> 1];
+    interlocked_xchg_add( (int *)&shm->seq, 1 );
+    shm->handle     = win->handle;
+    shm->parent     = win->parent ? win->parent->handle : 0;
+    shm->owner      = win->parent ? win->owner : 0;
+    shm->tid        = win->thread ? get_thread_id( win->thread ) : 0;
+    shm->pid        = win->thread ? get_process_id( win->thread->process ) : 0;
+    shm->style      = win->style;
+    shm->ex_style   = win->ex_style;
+    shm->id         = win->id;
+    shm->is_unicode = win->is_unicode;
+    shm->instance   = win->instance;
+    shm->user_data  = win->user_data;
+    shm->window     = win->window_rect;
+    shm->client     = win->client_rect;
+    interlocked_xchg_add( (int *)&shm->seq, 1 );
+}
+
+/* remove a destroyed window from the shared state */
+static void clear_window_shm( struct window *win )
+{
+    volatile window_shm_t *shm;
+
+    if (!window_shm) return;
+    shm = &window_shm[((win->handle & 0xffff) - FIRST_USER_HANDLE) >> 1];
+    interlocked_xchg_add( (int *)&shm->seq, 1 );
+    shm->handle = 0;
+    interlocked_xchg_add( (int *)&shm->seq, 1 );
+}
+
 /* get next window in Z-order list */
 static inline struct window *get_next_window( struct window *win )
 {
@@ -227,6 +287,7 @@ static void link_window( struct window *win, struct window *previous )
     }
 
     win->is_linked = 1;
+    update_window_shm( win );
 }
 
 /* change the parent of a window (or unlink the window if the new parent is NULL) */
@@ -401,6 +462,7 @@ static void detach_window_thread( struct window *win )
     /* destroyed when the desktop ref count reaches zero */
     release_object( win->desktop );
     win->thread = NULL;
+    update_window_shm( win );
 }
 
 /* get the process owning the top window of a given desktop */
@@ -527,6 +589,7 @@ static struct window *create_window( struct window *parent, struct window *owner
     }
 
     current->desktop_users++;
+    if (init_window_shm()) update_window_shm( win );
     return win;
 
 failed:
@@ -1657,6 +1720,7 @@ static void set_window_pos( struct window *win, struct window *previous,
     if (!(swp_flags & SWP_NOZORDER) && win->parent) link_window( win, previous );
     if (swp_flags & SWP_SHOWWINDOW) win->style |= WS_VISIBLE;
     else if (swp_flags & SWP_HIDEWINDOW) win->style &= ~WS_VISIBLE;
+    update_window_shm( win );
 
     /* keep children at the same position relative to top right corner when the parent is mirrored */
     if (win->ex_style & WS_EX_LAYOUTRTL)
@@ -1670,6 +1734,7 @@ static void set_window_pos( struct window *win, struct window *previous,
             offset_rect( &child->window_rect, new_size - old_size, 0 );
             offset_rect( &child->visible_rect, new_size - old_size, 0 );
             offset_rect( &child->client_rect, new_size - old_size, 0 );
+            update_window_shm( child );
         }
     }
 
@@ -1856,6 +1921,7 @@ void destroy_window( struct window *win )
     if (win == taskman_window) taskman_window = NULL;
     free_hotkeys( win->desktop, win->handle );
     cleanup_clipboard_window( win->desktop, win->handle );
+    clear_window_shm( win );
     free_user_handle( win->handle );
     destroy_properties( win );
     list_remove( &win->entry );
@@ -1967,6 +2033,7 @@ DECL_HANDLER(get_desktop_window)
         {
             detach_window_thread( desktop->top_window );
             desktop->top_window->style  = WS_POPUP | WS_VISIBLE | WS_CLIPSIBLINGS | WS_CLIPCHILDREN;
+            update_window_shm( desktop->top_window );
         }
     }
 
@@ -1979,6 +2046,7 @@ DECL_HANDLER(get_desktop_window)
         {
             detach_window_thread( desktop->msg_window );
             desktop->msg_window->style = WS_POPUP | WS_CLIPSIBLINGS | WS_CLIPCHILDREN;
+            update_window_shm( desktop->msg_window );
         }
     }
 
@@ -1988,6 +2056,14 @@ DECL_HANDLER(get_desktop_window)
 }
 
 
+/* get a handle to the mapping of the shared window state */
+DECL_HANDLER(get_window_shm)
+{
+    if (!init_window_shm()) return;
+    reply->handle = alloc_handle( current->process, window_shm_mapping, SECTION_QUERY | SECTION_MAP_READ, 0 );
+}
+
+
 /* set a window owner */
 DECL_HANDLER(set_window_owner)
 {
@@ -2014,6 +2090,7 @@ DECL_HANDLER(set_window_owner)
 
     reply->prev_owner = win->owner;
     reply->full_owner = win->owner = owner ? owner->handle : 0;
+    update_window_shm( win );
 }
 
 
@@ -2086,6 +2163,7 @@ DECL_HANDLER(set_window_info)
     if (req->flags & SET_WIN_USERDATA) win->user_data = req->user_data;
     if (req->flags & SET_WIN_EXTRA) memcpy( win->extra_bytes + req->extra_offset,
                                             &req->extra_value, req->extra_size );
+    if (req->flags) update_window_shm( win );
 
     /* changing window style triggers a non-client paint */
     if (req->flags & SET_WIN_STYLE) win->paint_flags |= PAINT_NONCLIENT;